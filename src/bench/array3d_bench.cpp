@@ -0,0 +1,417 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <uint17/array.h>
+#include <uint17/array_view.h>
+#include <uint17/array_with_vectors_view.h>
+#include <uint17/stencil.h>
+#include <uint17/text_io.h>
+
+using namespace uint17;
+
+/*
+  Every benchmark runs on Array<UInt17View> and, as a baseline, on std::vector<uint32_t> of the same length.
+  Sizes are numbers of elements. Run with --benchmark_out=<file> --benchmark_out_format=json
+  (or build the array3d_bench_json target) to keep results for comparing releases.
+ */
+namespace {
+
+using Vector = std::vector<uint32_t>;
+
+constexpr uint32_t kMask = (1u << 17) - 1;  // keeps baseline values in the range of Array
+
+template <typename Container>
+Container MakeFilled(size_t length) {
+  Container container(length);
+  std::mt19937 generator(42);
+  for (size_t i = 0; i != length; ++i) {
+    container[i] = static_cast<uint32_t>(generator()) & kMask;
+  }
+
+  return container;
+}
+
+std::vector<size_t> MakeRandomIndices(size_t count, size_t bound) {
+  std::vector<size_t> indices(count);
+  std::mt19937_64 generator(7);
+  std::uniform_int_distribution<size_t> distribution(0, bound - 1);
+  for (auto& index : indices) {
+    index = distribution(generator);
+  }
+
+  return indices;
+}
+
+uint32_t ValueOf(uint32_t value) { return value; }
+template <NumberView View>
+uint32_t ValueOf(const View& value) { return value.ToUInt32(); }
+
+void SetCounters(benchmark::State& state, size_t elements_per_iteration) {
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * elements_per_iteration));
+}
+
+// element access of the container itself
+
+template <typename Container>
+void BM_SequentialGet(benchmark::State& state) {
+  const auto length = static_cast<size_t>(state.range(0));
+  const auto container = MakeFilled<Container>(length);
+  for (auto _ : state) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i != length; ++i) {
+      sum += ValueOf(container[i]);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  SetCounters(state, length);
+}
+
+template <typename Container>
+void BM_SequentialSet(benchmark::State& state) {
+  const auto length = static_cast<size_t>(state.range(0));
+  Container container(length);
+  for (auto _ : state) {
+    for (size_t i = 0; i != length; ++i) {
+      container[i] = static_cast<uint32_t>(i) & kMask;
+    }
+    benchmark::ClobberMemory();
+  }
+  SetCounters(state, length);
+}
+
+template <typename Container>
+void BM_RandomGet(benchmark::State& state) {
+  const auto length = static_cast<size_t>(state.range(0));
+  const auto container = MakeFilled<Container>(length);
+  const auto indices = MakeRandomIndices(length, length);
+  for (auto _ : state) {
+    uint64_t sum = 0;
+    for (const auto index : indices) {
+      sum += ValueOf(container[index]);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  SetCounters(state, indices.size());
+}
+
+template <typename Container>
+void BM_RandomSet(benchmark::State& state) {
+  const auto length = static_cast<size_t>(state.range(0));
+  Container container(length);
+  const auto indices = MakeRandomIndices(length, length);
+  for (auto _ : state) {
+    for (const auto index : indices) {
+      container[index] = static_cast<uint32_t>(index) & kMask;
+    }
+    benchmark::ClobberMemory();
+  }
+  SetCounters(state, indices.size());
+}
+
+// element access through ArrayView(i, j, k) of a cube with edge state.range(0)
+
+template <size_t Dimension>
+std::vector<std::array<size_t, Dimension>> MakeViewIndices(size_t edge, bool random) {
+  size_t length = 1;
+  for (size_t i = 0; i != Dimension; ++i) {
+    length *= edge;
+  }
+  std::vector<std::array<size_t, Dimension>> indices(length);
+  const auto order = MakeRandomIndices(length, length);
+  for (size_t n = 0; n != length; ++n) {
+    auto flat = random ? order[n] : n;
+    for (size_t axis = Dimension; axis != 0; --axis) {
+      indices[n][axis - 1] = flat % edge;
+      flat /= edge;
+    }
+  }
+
+  return indices;
+}
+
+template <typename Container, size_t Dimension>
+ArrayView<Dimension, Container> MakeCubeView(Container& container, size_t edge) {
+  size_t dimensions[Dimension];
+  for (auto& dimension : dimensions) {
+    dimension = edge;
+  }
+
+  return ArrayView<Dimension, Container>(container, 0, dimensions);
+}
+
+template <typename Container, size_t Dimension, bool Random>
+void BM_ViewGet(benchmark::State& state) {
+  const auto edge = static_cast<size_t>(state.range(0));
+  const auto indices = MakeViewIndices<Dimension>(edge, Random);
+  auto container = MakeFilled<Container>(indices.size());
+  const auto view = MakeCubeView<Container, Dimension>(container, edge);
+  for (auto _ : state) {
+    uint64_t sum = 0;
+    for (const auto& index : indices) {
+      sum += std::apply([&](auto... i) { return ValueOf(view(i...)); }, index);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  SetCounters(state, indices.size());
+}
+
+template <typename Container, size_t Dimension, bool Random>
+void BM_ViewSet(benchmark::State& state) {
+  const auto edge = static_cast<size_t>(state.range(0));
+  const auto indices = MakeViewIndices<Dimension>(edge, Random);
+  Container container(indices.size());
+  auto view = MakeCubeView<Container, Dimension>(container, edge);
+  for (auto _ : state) {
+    uint32_t value = 0;
+    for (const auto& index : indices) {
+      std::apply([&](auto... i) { view(i...) = value; }, index);
+      value = (value + 1) & kMask;
+    }
+    benchmark::ClobberMemory();
+  }
+  SetCounters(state, indices.size());
+}
+
+// arithmetic of views, the baseline is the same loop over std::vector
+
+enum class Operation { kPlus, kMinus, kMultiply };
+
+template <Operation Op>
+void BM_ArrayArithmetic(benchmark::State& state) {
+  const auto length = static_cast<size_t>(state.range(0));
+  auto lhs = MakeFilled<Array<UInt17View>>(length);
+  auto rhs = MakeFilled<Array<UInt17View>>(length);
+  Array result(length);
+  ArrayWithVectorsView<1> lhs_view(lhs, 0, length);
+  ArrayWithVectorsView<1> rhs_view(rhs, 0, length);
+  ArrayWithVectorsView<1> result_view(result, 0, length);
+  for (auto _ : state) {
+    if constexpr (Op == Operation::kPlus) {
+      result_view = lhs_view + rhs_view;
+    } else if constexpr (Op == Operation::kMinus) {
+      result_view = lhs_view - rhs_view;
+    } else {
+      result_view = lhs_view * 3u;
+    }
+    benchmark::ClobberMemory();
+  }
+  SetCounters(state, length);
+}
+
+template <Operation Op>
+void BM_VectorArithmetic(benchmark::State& state) {
+  const auto length = static_cast<size_t>(state.range(0));
+  const auto lhs = MakeFilled<Vector>(length);
+  const auto rhs = MakeFilled<Vector>(length);
+  Vector result(length);
+  for (auto _ : state) {
+    for (size_t i = 0; i != length; ++i) {
+      if constexpr (Op == Operation::kPlus) {
+        result[i] = (lhs[i] + rhs[i]) & kMask;
+      } else if constexpr (Op == Operation::kMinus) {
+        result[i] = (lhs[i] - rhs[i]) & kMask;
+      } else {
+        result[i] = (lhs[i] * 3u) & kMask;
+      }
+    }
+    benchmark::ClobberMemory();
+  }
+  SetCounters(state, length);
+}
+
+// copy and move
+
+template <typename Container>
+void BM_Copy(benchmark::State& state) {
+  const auto length = static_cast<size_t>(state.range(0));
+  const auto source = MakeFilled<Container>(length);
+  for (auto _ : state) {
+    Container copy(source);
+    benchmark::DoNotOptimize(copy);
+  }
+  SetCounters(state, length);
+}
+
+template <typename Container>
+void BM_Move(benchmark::State& state) {
+  const auto length = static_cast<size_t>(state.range(0));
+  auto source = MakeFilled<Container>(length);
+  for (auto _ : state) {
+    Container moved(std::move(source));
+    source = std::move(moved);
+    benchmark::DoNotOptimize(source);
+  }
+}
+
+// text input / output, the baseline goes through the stream operators of uint32_t
+
+void BM_ArrayTextWrite(benchmark::State& state) {
+  const auto length = static_cast<size_t>(state.range(0));
+  const auto array = MakeFilled<Array<UInt17View>>(length);
+  for (auto _ : state) {
+    std::ostringstream stream;
+    text::Write(stream, array, 0, length);
+    benchmark::DoNotOptimize(stream.str().size());
+  }
+  SetCounters(state, length);
+}
+
+void BM_VectorTextWrite(benchmark::State& state) {
+  const auto length = static_cast<size_t>(state.range(0));
+  const auto vector = MakeFilled<Vector>(length);
+  for (auto _ : state) {
+    std::ostringstream stream;
+    for (size_t i = 0; i != length; ++i) {
+      if (i != 0) {
+        stream << ' ';
+      }
+      stream << vector[i];
+    }
+    benchmark::DoNotOptimize(stream.str().size());
+  }
+  SetCounters(state, length);
+}
+
+std::string MakeText(size_t length) {
+  const auto array = MakeFilled<Array<UInt17View>>(length);
+  std::ostringstream stream;
+  text::Write(stream, array, 0, length);
+
+  return stream.str();
+}
+
+void BM_ArrayTextRead(benchmark::State& state) {
+  const auto length = static_cast<size_t>(state.range(0));
+  const auto input = MakeText(length);
+  Array array(length);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(text::Read(input, array, 0, length));
+  }
+  SetCounters(state, length);
+}
+
+void BM_VectorTextRead(benchmark::State& state) {
+  const auto length = static_cast<size_t>(state.range(0));
+  const auto input = MakeText(length);
+  Vector vector(length);
+  for (auto _ : state) {
+    std::istringstream stream(input);
+    for (auto& value : vector) {
+      stream >> value;
+    }
+    benchmark::DoNotOptimize(vector.data());
+  }
+  SetCounters(state, length);
+}
+
+// 27-point smoothing of a cube with edge state.range(0), the baseline indexes v[i][j][k] for every neighbour
+
+void BM_ApplyStencil(benchmark::State& state) {
+  const auto edge = static_cast<size_t>(state.range(0));
+  auto input = MakeFilled<Array<UInt17View>>(edge * edge * edge);
+  Array output(edge * edge * edge);
+  ArrayView<3> input_view(input, 0, edge, edge, edge);
+  ArrayView<3> output_view(output, 0, edge, edge, edge);
+  const auto stencil = Stencil::TwentySevenPoint(1, 1, 1, 1, 27);
+  for (auto _ : state) {
+    ApplyStencil(input_view, output_view, stencil, Boundary::kClamp);
+    benchmark::ClobberMemory();
+  }
+  SetCounters(state, edge * edge * edge);
+}
+
+void BM_IndexStencil(benchmark::State& state) {
+  const auto edge = static_cast<size_t>(state.range(0));
+  auto input = MakeFilled<Array<UInt17View>>(edge * edge * edge);
+  Array output(edge * edge * edge);
+  ArrayView<3> input_view(input, 0, edge, edge, edge);
+  ArrayView<3> output_view(output, 0, edge, edge, edge);
+  const auto clamp = [edge](size_t index, int offset) {
+    const auto result = static_cast<std::ptrdiff_t>(index) + offset;
+
+    return (result < 0) ? size_t{0} : (static_cast<size_t>(result) >= edge) ? edge - 1 : static_cast<size_t>(result);
+  };
+  for (auto _ : state) {
+    for (size_t i = 0; i != edge; ++i) {
+      for (size_t j = 0; j != edge; ++j) {
+        for (size_t k = 0; k != edge; ++k) {
+          uint32_t sum = 0;
+          for (int di = -1; di <= 1; ++di) {
+            for (int dj = -1; dj <= 1; ++dj) {
+              for (int dk = -1; dk <= 1; ++dk) {
+                sum += input_view[clamp(i, di)][clamp(j, dj)][clamp(k, dk)].ToUInt32();
+              }
+            }
+          }
+          output_view[i][j][k] = sum / 27;
+        }
+      }
+    }
+    benchmark::ClobberMemory();
+  }
+  SetCounters(state, edge * edge * edge);
+}
+
+}  // namespace
+
+#define ARRAY3D_BENCHMARK_PAIR(name, ...)                                    \
+  BENCHMARK_TEMPLATE(name, Array<UInt17View>)->__VA_ARGS__;                \
+  BENCHMARK_TEMPLATE(name, Vector)->__VA_ARGS__
+
+ARRAY3D_BENCHMARK_PAIR(BM_SequentialGet, Range(1 << 10, 1 << 22));
+ARRAY3D_BENCHMARK_PAIR(BM_SequentialSet, Range(1 << 10, 1 << 22));
+ARRAY3D_BENCHMARK_PAIR(BM_RandomGet, Range(1 << 10, 1 << 22));
+ARRAY3D_BENCHMARK_PAIR(BM_RandomSet, Range(1 << 10, 1 << 22));
+
+BENCHMARK_TEMPLATE(BM_ViewGet, Array<UInt17View>, 1, false)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_ViewGet, Vector, 1, false)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_ViewGet, Array<UInt17View>, 2, false)->Arg(512);
+BENCHMARK_TEMPLATE(BM_ViewGet, Vector, 2, false)->Arg(512);
+BENCHMARK_TEMPLATE(BM_ViewGet, Array<UInt17View>, 3, false)->Arg(64);
+BENCHMARK_TEMPLATE(BM_ViewGet, Vector, 3, false)->Arg(64);
+BENCHMARK_TEMPLATE(BM_ViewGet, Array<UInt17View>, 1, true)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_ViewGet, Vector, 1, true)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_ViewGet, Array<UInt17View>, 2, true)->Arg(512);
+BENCHMARK_TEMPLATE(BM_ViewGet, Vector, 2, true)->Arg(512);
+BENCHMARK_TEMPLATE(BM_ViewGet, Array<UInt17View>, 3, true)->Arg(64);
+BENCHMARK_TEMPLATE(BM_ViewGet, Vector, 3, true)->Arg(64);
+BENCHMARK_TEMPLATE(BM_ViewSet, Array<UInt17View>, 1, false)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_ViewSet, Vector, 1, false)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_ViewSet, Array<UInt17View>, 2, false)->Arg(512);
+BENCHMARK_TEMPLATE(BM_ViewSet, Vector, 2, false)->Arg(512);
+BENCHMARK_TEMPLATE(BM_ViewSet, Array<UInt17View>, 3, false)->Arg(64);
+BENCHMARK_TEMPLATE(BM_ViewSet, Vector, 3, false)->Arg(64);
+BENCHMARK_TEMPLATE(BM_ViewSet, Array<UInt17View>, 1, true)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_ViewSet, Vector, 1, true)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_ViewSet, Array<UInt17View>, 2, true)->Arg(512);
+BENCHMARK_TEMPLATE(BM_ViewSet, Vector, 2, true)->Arg(512);
+BENCHMARK_TEMPLATE(BM_ViewSet, Array<UInt17View>, 3, true)->Arg(64);
+BENCHMARK_TEMPLATE(BM_ViewSet, Vector, 3, true)->Arg(64);
+
+BENCHMARK_TEMPLATE(BM_ArrayArithmetic, Operation::kPlus)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_VectorArithmetic, Operation::kPlus)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_ArrayArithmetic, Operation::kMinus)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_VectorArithmetic, Operation::kMinus)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_ArrayArithmetic, Operation::kMultiply)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_VectorArithmetic, Operation::kMultiply)->Range(1 << 10, 1 << 22);
+
+ARRAY3D_BENCHMARK_PAIR(BM_Copy, Range(1 << 10, 1 << 22));
+ARRAY3D_BENCHMARK_PAIR(BM_Move, Arg(1 << 22));
+
+BENCHMARK(BM_ArrayTextWrite)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_VectorTextWrite)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_ArrayTextRead)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_VectorTextRead)->Range(1 << 10, 1 << 20);
+
+BENCHMARK(BM_ApplyStencil)->Arg(32)->Arg(128);
+BENCHMARK(BM_IndexStencil)->Arg(32)->Arg(128);
+
+BENCHMARK_MAIN();
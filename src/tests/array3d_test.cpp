@@ -1,17 +1,40 @@
 #include <stdexcept>
 #include <string>
 #include <sstream>
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <utility>
+#include <vector>
+#include <thread>
+#include <filesystem>
+#include <atomic>
 #include <gtest/gtest.h>
 #include <uint17/array.h>
 #include <uint17/uint17_view.h>
 #include <uint17/array_view.h>
 #include <uint17/array_with_vectors_view.h>
+#include <uint17/static_array_view.h>
+#include <uint17/strided_array_view.h>
+#include <uint17/mapped_array.h>
+#include <uint17/binary_io.h>
+#include <uint17/text_io.h>
+#include <uint17/thread_pool.h>
+#include <uint17/parallel.h>
+#include <uint17/atomic_view.h>
+#include <uint17/reductions.h>
+#include <uint17/buffer_pool.h>
+#include <uint17/array_handle.h>
+#include <uint17/bricked_array.h>
+#include <uint17/stencil.h>
+#include <uint17/compressed_array.h>
+#include <uint17/bit_sliced_array.h>
 
 using namespace uint17;
 
 TEST(UInt17ViewTest, OffsetTest) {
-  uint8_t data1[3];
-  uint8_t data2[3];
+  uint8_t data1[3 + packing::kTailSlack];
+  uint8_t data2[3 + packing::kTailSlack];
 
   UInt17View number1(data1, 2);
   number1 = 25u;
@@ -24,7 +47,7 @@ TEST(UInt17ViewTest, OffsetTest) {
 
 TEST(UInt17ViewTest, FromUInt16Test) {
   uint16_t val = 32;
-  uint8_t data[3];
+  uint8_t data[3 + packing::kTailSlack];
 
   UInt17View number(data, 0);
 
@@ -35,7 +58,7 @@ TEST(UInt17ViewTest, FromUInt16Test) {
 
 TEST(UInt17ViewTest, FromUInt32Test) {
   uint32_t val = 65000;
-  uint8_t data[3];
+  uint8_t data[3 + packing::kTailSlack];
 
   UInt17View number(data, 0);
 
@@ -46,8 +69,8 @@ TEST(UInt17ViewTest, FromUInt32Test) {
 
 TEST(UInt17ViewTest, FromAnotherUInt17ViewTest) {
   uint32_t val = 65000;
-  uint8_t data1[3];
-  uint8_t data2[3];
+  uint8_t data1[3 + packing::kTailSlack];
+  uint8_t data2[3 + packing::kTailSlack];
 
   UInt17View number1(data1, 0);
   UInt17View number2(data2, 0);
@@ -60,7 +83,7 @@ TEST(UInt17ViewTest, FromAnotherUInt17ViewTest) {
 
 TEST(UInt17ViewTest, SetToZeroTest) {
   uint32_t val = 65000;
-  uint8_t data[3];
+  uint8_t data[3 + packing::kTailSlack];
 
   UInt17View number(data, 0);
 
@@ -76,9 +99,9 @@ TEST(UInt17ViewTest, PlusTest) {
   uint32_t val3 = 50;
   uint32_t val4 = 10;
 
-  uint8_t data1[3];
-  uint8_t data2[3];
-  uint8_t data3[3];
+  uint8_t data1[3 + packing::kTailSlack];
+  uint8_t data2[3 + packing::kTailSlack];
+  uint8_t data3[3 + packing::kTailSlack];
 
   UInt17View number1(data1, 0);
   UInt17View number2(data2, 0);
@@ -101,9 +124,9 @@ TEST(UInt17ViewTest, MinusTest) {
   uint32_t val3 = 50;
   uint32_t val4 = 10;
 
-  uint8_t data1[3];
-  uint8_t data2[3];
-  uint8_t data3[3];
+  uint8_t data1[3 + packing::kTailSlack];
+  uint8_t data2[3 + packing::kTailSlack];
+  uint8_t data3[3 + packing::kTailSlack];
 
   UInt17View number1(data1, 0);
   UInt17View number2(data2, 0);
@@ -126,9 +149,9 @@ TEST(UInt17ViewTest, MultTest) {
   uint32_t val3 = 50;
   uint32_t val4 = 10;
 
-  uint8_t data1[3];
-  uint8_t data2[3];
-  uint8_t data3[3];
+  uint8_t data1[3 + packing::kTailSlack];
+  uint8_t data2[3 + packing::kTailSlack];
+  uint8_t data3[3 + packing::kTailSlack];
 
   UInt17View number1(data1, 0);
   UInt17View number2(data2, 0);
@@ -241,6 +264,54 @@ TEST(ArrayTest, AtTest) {
   ASSERT_THROW(array.At(4), std::out_of_range);
 }
 
+TEST(ArrayTest, UnpackTest) {
+  Array array(37);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>(i * 3541 + 17);
+  }
+
+  uint32_t values[37];
+  array.Unpack(3, 30, values);
+
+  for (size_t i = 0; i != 30; ++i) {
+    ASSERT_EQ(values[i], array[3 + i].ToUInt32());
+  }
+  ASSERT_THROW(array.Unpack(30, 8, values), std::out_of_range);
+}
+
+TEST(ArrayTest, PackTest) {
+  Array array(37);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = 131071u;
+  }
+
+  uint32_t values[30];
+  for (size_t i = 0; i != 30; ++i) {
+    values[i] = static_cast<uint32_t>(i * 4099);
+  }
+  array.Pack(values, 5, 30);
+
+  for (size_t i = 0; i != 5; ++i) {
+    ASSERT_EQ(array[i].ToUInt32(), 131071u);
+  }
+  for (size_t i = 0; i != 30; ++i) {
+    ASSERT_EQ(array[5 + i].ToUInt32(), values[i]);
+  }
+  ASSERT_EQ(array[35].ToUInt32(), 131071u);
+  ASSERT_EQ(array[36].ToUInt32(), 131071u);
+  ASSERT_THROW(array.Pack(values, 36, 2), std::out_of_range);
+}
+
+TEST(ArrayTest, PackTruncatesTest) {
+  Array array(8);
+  uint32_t values[8] = {131072, 131073, 1, 2, 3, 4, 5, 6};
+  array.Pack(values, 0, 8);
+
+  ASSERT_EQ(array[0].ToUInt32(), 0u);
+  ASSERT_EQ(array[1].ToUInt32(), 1u);
+  ASSERT_EQ(array[7].ToUInt32(), 6u);
+}
+
 TEST(Array1DViewTest, EmptyTest) {
   Array array = {1, 2, 3, 4, 5};
   ArrayView<1> view(array);
@@ -298,7 +369,7 @@ TEST(Array1DViewTest, MultTest) {
   Array array1 = {1, 2, 3, 4, 5};
   ArrayWithVectorsView<1> view(array1);
   uint32_t lambda = 2;
-  auto [result, array] = view * lambda;
+  auto [result, array] = (view * lambda).Evaluate();
   ASSERT_EQ(result[0].ToUInt32(), view[0].ToUInt32() * lambda);
   ASSERT_EQ(result[1].ToUInt32(), view[1].ToUInt32() * lambda);
   ASSERT_EQ(result[2].ToUInt32(), view[2].ToUInt32() * lambda);
@@ -316,7 +387,7 @@ TEST(Array1DViewTest, PlusTest) {
   ArrayWithVectorsView<1> view2(array2);
   ArrayWithVectorsView<1> view3(array3);
 
-  auto [result, array] = view1 + view2;
+  auto [result, array] = (view1 + view2).Evaluate();
 
   ASSERT_ANY_THROW(view2 + view3);
   ASSERT_EQ(result[0].ToUInt32(), view1[0].ToUInt32() + view2[0].ToUInt32());
@@ -337,7 +408,7 @@ TEST(Array1DViewTest, MinusTest) {
   ArrayWithVectorsView<1> view2(array2);
   ArrayWithVectorsView<1> view3(array3);
 
-  auto [result, array] = view1 - view2;
+  auto [result, array] = (view1 - view2).Evaluate();
 
   ASSERT_ANY_THROW(view2 - view3);
   ASSERT_EQ(result[0].ToUInt32(), view1[0].ToUInt32() - view2[0].ToUInt32());
@@ -458,7 +529,7 @@ TEST(Array2DViewTest, MultTest) {
   Array array1 = {1, 2, 3, 4, 5, 6};
   ArrayWithVectorsView<2> view(array1, 0, 2u, 3u);
   uint32_t lambda = 2;
-  auto [result, array] = view * lambda;
+  auto [result, array] = (view * lambda).Evaluate();
   ASSERT_EQ(result.Get(0u, 0u).ToUInt32(), view.Get(0u, 0u).ToUInt32() * lambda);
   ASSERT_EQ(result.Get(0u, 1u).ToUInt32(), view.Get(0u, 1u).ToUInt32() * lambda);
   ASSERT_EQ(result.Get(0u, 2u).ToUInt32(), view.Get(0u, 2u).ToUInt32() * lambda);
@@ -477,7 +548,7 @@ TEST(Array2DViewTest, PlusTest) {
   ArrayWithVectorsView<2> view2(array2, 1, 2u, 3u);
   ArrayWithVectorsView<2> view3(array3, 0, 3u, 2u);
 
-  auto [result, array] = view1 + view2;
+  auto [result, array] = (view1 + view2).Evaluate();
 
   ASSERT_ANY_THROW(view2 + view3);
   ASSERT_EQ(result.Get(0u, 0u).ToUInt32(), view1.Get(0u, 0u).ToUInt32() + view2.Get(0u, 0u).ToUInt32());
@@ -499,7 +570,7 @@ TEST(Array2DViewTest, MinusTest) {
   ArrayWithVectorsView<2> view2(array2, 0, 2u, 3u);
   ArrayWithVectorsView<2> view3(array3, 0, 3u, 2u);
 
-  auto [result, array] = view1 - view2;
+  auto [result, array] = (view1 - view2).Evaluate();
 
   ASSERT_ANY_THROW(view2 - view3);
   ASSERT_EQ(result.Get(0u, 0u).ToUInt32(), view1.Get(0u, 0u).ToUInt32() - view2.Get(0u, 0u).ToUInt32());
@@ -607,7 +678,7 @@ TEST(Array3DViewTest, MultTest) {
   Array array1 = {1, 2, 3, 4, 5, 6, 7, 8};
   ArrayWithVectorsView<3> view(array1, 0, 2u, 2u, 2u);
   uint32_t lambda = 2;
-  auto [result, array] = view * lambda;
+  auto [result, array] = (view * lambda).Evaluate();
   ASSERT_EQ(result.Get(0u, 0u, 0u).ToUInt32(), view.Get(0u, 0u, 0u).ToUInt32() * lambda);
   ASSERT_EQ(result.Get(0u, 0u, 1u).ToUInt32(), view.Get(0u, 0u, 1u).ToUInt32() * lambda);
   ASSERT_EQ(result.Get(0u, 1u, 0u).ToUInt32(), view.Get(0u, 1u, 0u).ToUInt32() * lambda);
@@ -628,7 +699,7 @@ TEST(Array3DViewTest, PlusTest) {
   ArrayWithVectorsView<3> view2(array2, 1, 2u, 2u, 2u);
   ArrayWithVectorsView<3> view3(array3, 0, 2u, 2u, 3u);
 
-  auto [result, array] = view1 + view2;
+  auto [result, array] = (view1 + view2).Evaluate();
 
   ASSERT_ANY_THROW(view2 + view3);
   ASSERT_EQ(result.Get(0u, 0u, 0u).ToUInt32(), view1.Get(0u, 0u, 0u).ToUInt32() + view2.Get(0u, 0u, 0u).ToUInt32());
@@ -652,7 +723,7 @@ TEST(Array3DViewTest, MinusTest) {
   ArrayWithVectorsView<3> view2(array2, 0, 2u, 2u, 2u);
   ArrayWithVectorsView<3> view3(array3, 0, 2u, 2u, 3u);
 
-  auto [result, array] = view1 - view2;
+  auto [result, array] = (view1 - view2).Evaluate();
 
   ASSERT_ANY_THROW(view2 - view3);
   ASSERT_EQ(result.Get(0u, 0u, 0u).ToUInt32(), view1.Get(0u, 0u, 0u).ToUInt32() - view2.Get(0u, 0u, 0u).ToUInt32());
@@ -712,4 +783,1411 @@ TEST(Array3DViewTest, OutputTest) {
   ArrayWithVectorsView<3> view(array, 0, 2u, 2u, 2u);
   output_stream << view;
   ASSERT_EQ(output_stream.str(), "1 2 3 4 5 6 7 8");
-}
\ No newline at end of file
+}
+TEST(Array3DViewTest, BlockedOperatorsTest) {
+  const size_t start = 3;
+  const size_t x = 10;
+  const size_t y = 11;
+  const size_t z = 13;
+  Array array1(start + x * y * z);
+  Array array2(x * y * z + 1);
+  for (size_t i = 0; i != array1.size(); ++i) {
+    array1[i] = static_cast<uint32_t>(i * 7919 + 5);
+  }
+  for (size_t i = 0; i != array2.size(); ++i) {
+    array2[i] = static_cast<uint32_t>(i * 104729 + 11);
+  }
+  ArrayWithVectorsView<3> view1(array1, start, x, y, z);
+  ArrayWithVectorsView<3> view2(array2, 1, x, y, z);
+  const uint32_t lambda = 100003;
+
+  auto [sum, sum_array] = (view1 + view2).Evaluate();
+  auto [difference, difference_array] = (view1 - view2).Evaluate();
+  auto [product, product_array] = (view1 * lambda).Evaluate();
+
+  const uint32_t mask = (1u << UInt17View::kBitLength) - 1;
+  for (size_t i = 0; i != x * y * z; ++i) {
+    const auto lhs = array1[start + i].ToUInt32();
+    const auto rhs = array2[1 + i].ToUInt32();
+    ASSERT_EQ(sum_array->At(i).ToUInt32(), (lhs + rhs) & mask);
+    ASSERT_EQ(difference_array->At(i).ToUInt32(), (lhs - rhs) & mask);
+    ASSERT_EQ(product_array->At(i).ToUInt32(), (lhs * lambda) & mask);
+  }
+  delete sum_array;
+  delete difference_array;
+  delete product_array;
+}
+
+TEST(Array3DViewTest, ChainedExpressionTest) {
+  Array array1 = {1, 2, 3, 4, 5, 6, 7, 8};
+  Array array2 = {10, 20, 30, 40, 50, 60, 70, 80};
+  Array array3 = {1, 1, 1, 1, 1, 1, 1, 1};
+  Array destination(9);
+  ArrayWithVectorsView<3> view1(array1, 0, 2u, 2u, 2u);
+  ArrayWithVectorsView<3> view2(array2, 0, 2u, 2u, 2u);
+  ArrayWithVectorsView<3> view3(array3, 0, 2u, 2u, 2u);
+  ArrayWithVectorsView<3> result(destination, 1, 2u, 2u, 2u);
+
+  result = view1 + view2 * 3u - view3;
+
+  for (size_t i = 0; i != 8; ++i) {
+    ASSERT_EQ(destination[1 + i].ToUInt32(), array1[i].ToUInt32() + array2[i].ToUInt32() * 3 - 1);
+  }
+
+  auto [evaluated, evaluated_array] = (2u * (view1 - view3) + view2).Evaluate();
+  ASSERT_EQ(evaluated_array->size(), 8u);
+  for (size_t i = 0; i != 8; ++i) {
+    ASSERT_EQ(evaluated_array->At(i).ToUInt32(), 2 * (array1[i].ToUInt32() - 1) + array2[i].ToUInt32());
+  }
+  delete evaluated_array;
+}
+
+TEST(Array3DViewTest, ExpressionAliasingTest) {
+  Array array1 = {1, 2, 3, 4, 5, 6, 7, 8};
+  Array array2 = {10, 20, 30, 40, 50, 60, 70, 80};
+  ArrayWithVectorsView<3> view1(array1, 0, 2u, 2u, 2u);
+  ArrayWithVectorsView<3> view2(array2, 0, 2u, 2u, 2u);
+
+  view1 = view1 + view2;
+
+  for (size_t i = 0; i != 8; ++i) {
+    ASSERT_EQ(array1[i].ToUInt32(), (i + 1) * 11);
+  }
+}
+
+TEST(Array3DViewTest, ExpressionWrongDestinationTest) {
+  Array array1(8);
+  Array array2(12);
+  ArrayWithVectorsView<3> view1(array1, 0, 2u, 2u, 2u);
+  ArrayWithVectorsView<3> view2(array2, 0, 2u, 2u, 3u);
+
+  ASSERT_THROW(view2 = view1 * 2u, std::logic_error);
+}
+
+TEST(Array1DViewTest, CompoundAssignmentTest) {
+  Array array1 = {1, 2, 3, 4, 5};
+  Array array2 = {10, 20, 30, 40, 50};
+  Array array3 = {1, 2};
+  ArrayWithVectorsView<1> view1(array1);
+  ArrayWithVectorsView<1> view2(array2);
+  ArrayWithVectorsView<1> view3(array3);
+
+  view1 += view2;
+  ASSERT_EQ(array1[4].ToUInt32(), 55u);
+  view1 -= view2 * 2u;
+  ASSERT_EQ(array1[4].ToUInt32(), (5u - 50u) & 131071u);
+  view2 *= 3u;
+  ASSERT_EQ(array2[1].ToUInt32(), 60u);
+  view2 += 7u;
+  ASSERT_EQ(array2[1].ToUInt32(), 67u);
+  view2 -= 8u;
+  ASSERT_EQ(array2[1].ToUInt32(), 59u);
+  ASSERT_ANY_THROW(view3 += view1);
+  ASSERT_ANY_THROW(view3 -= view1);
+}
+
+TEST(Array3DViewTest, CompoundAssignmentTest) {
+  Array array1(20);
+  Array array2(20);
+  for (size_t i = 0; i != 20; ++i) {
+    array1[i] = static_cast<uint32_t>(i);
+    array2[i] = static_cast<uint32_t>(100 * i);
+  }
+  ArrayWithVectorsView<3> view1(array1, 2, 2u, 3u, 3u);
+  ArrayWithVectorsView<3> view2(array2, 1, 2u, 3u, 3u);
+
+  view1 += view2;
+  view1 *= 2u;
+
+  ASSERT_EQ(array1[0].ToUInt32(), 0u);
+  ASSERT_EQ(array1[1].ToUInt32(), 1u);
+  for (size_t i = 0; i != 18; ++i) {
+    ASSERT_EQ(array1[2 + i].ToUInt32(), 2 * ((2 + i) + 100 * (1 + i)));
+  }
+  ASSERT_EQ(array1[19].ToUInt32(), 2 * (19u + 1800u));
+}
+
+TEST(ArrayIteratorTest, ConceptTest) {
+  static_assert(std::random_access_iterator<Array<>::iterator>);
+  static_assert(std::random_access_iterator<Array<>::const_iterator>);
+  static_assert(std::ranges::random_access_range<Array<>>);
+}
+
+TEST(ArrayIteratorTest, SequentialTest) {
+  Array array(29);
+  uint32_t value = 0;
+  for (auto element : array) {
+    element = value;
+    value += 4567;
+  }
+
+  for (size_t i = 0; i != array.size(); ++i) {
+    ASSERT_EQ(array[i].ToUInt32(), (i * 4567) & 131071u);
+  }
+}
+
+TEST(ArrayIteratorTest, RandomAccessTest) {
+  Array array = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  auto it = array.begin() + 7;
+
+  ASSERT_EQ((*it).ToUInt32(), 8u);
+  ASSERT_EQ(it[-5].ToUInt32(), 3u);
+  ASSERT_EQ((*(it - 6)).ToUInt32(), 2u);
+  ASSERT_EQ(array.end() - array.begin(), 10);
+  ASSERT_EQ(it - array.begin(), 7);
+  ASSERT_TRUE(array.begin() < it);
+  ASSERT_EQ(--it, array.begin() + 6);
+  Array<>::const_iterator const_it = it;
+  ASSERT_EQ((*const_it).ToUInt32(), 7u);
+}
+
+TEST(ArrayIteratorTest, AlgorithmsTest) {
+  Array array = {5, 1, 4, 2, 3};
+
+  ASSERT_EQ(std::accumulate(array.begin(), array.end(), uint64_t{0}), 15u);
+  ASSERT_EQ(*std::max_element(array.begin(), array.end()), 5u);
+  ASSERT_EQ(std::count(array.begin(), array.end(), 4u), 1);
+  std::fill(array.begin() + 1, array.begin() + 3, 100000u);
+  ASSERT_EQ(array[1].ToUInt32(), 100000u);
+  ASSERT_EQ(array[2].ToUInt32(), 100000u);
+  ASSERT_EQ(array[3].ToUInt32(), 2u);
+}
+
+TEST(ArrayIteratorTest, ViewIteratorsTest) {
+  Array array = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+  ArrayView<3> view(array, 1, 2u, 2u, 2u);
+  ArrayView<1> view1d(array, 2, 3);
+
+  ASSERT_EQ(std::accumulate(view.begin(), view.end(), uint64_t{0}), 44u);
+  ASSERT_EQ(std::accumulate(view1d.begin(), view1d.end(), uint64_t{0}), 12u);
+
+  std::vector<std::string> words = {"hello", "world", "some", "words"};
+  ArrayView<2, std::vector<std::string>> words_view(words, 0, 2u, 2u);
+  ASSERT_EQ(std::distance(words_view.begin(), words_view.end()), 4);
+  ASSERT_EQ(*(words_view.begin() + 3), "words");
+}
+
+TEST(UIntNViewTest, WidthsTest) {
+  uint8_t data[5 + packing::kTailSlack] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF};  // element access may read kTailSlack bytes past the numbers
+
+  UIntNView<12> number12(data, 3);
+  number12 = 4000u;
+  ASSERT_EQ(number12.ToUInt32(), 4000u);
+  ASSERT_EQ(data[0] >> 5, 0b111);
+  ASSERT_EQ(data[1] & 0b1, 0b1);
+
+  UIntNView<32> number32(data, 7);
+  number32 = 0xDEADBEEFu;
+  ASSERT_EQ(number32.ToUInt32(), 0xDEADBEEFu);
+
+  UIntNView<1> number1(data, 4);
+  number1 = 3u;
+  ASSERT_EQ(number1.ToUInt32(), 1u);
+}
+
+TEST(UIntNViewTest, ArrayOfWidthsTest) {
+  Array<UIntNView<12>> array12(21);
+  Array<UIntNView<20>> array20(21);
+  for (size_t i = 0; i != 21; ++i) {
+    array12[i] = static_cast<uint32_t>(i * 191);
+    array20[i] = static_cast<uint32_t>(i * 49999);
+  }
+
+  uint32_t values[21];
+  array12.Unpack(0, 21, values);
+  for (size_t i = 0; i != 21; ++i) {
+    ASSERT_EQ(values[i], (i * 191) & 4095u);
+  }
+  array20.Unpack(0, 21, values);
+  for (size_t i = 0; i != 21; ++i) {
+    ASSERT_EQ(values[i], (i * 49999) & 1048575u);
+  }
+  array20.Pack(values + 1, 3, 17);
+  for (size_t i = 0; i != 17; ++i) {
+    ASSERT_EQ(array20[3 + i].ToUInt32(), ((i + 1) * 49999) & 1048575u);
+  }
+}
+
+TEST(UIntNViewTest, VectorsViewTest) {
+  Array<UIntNView<12>> array = {4000, 100, 200, 300};
+  ArrayWithVectorsView<2, Array<UIntNView<12>>> view(array, 0, 2u, 2u);
+
+  view += view;
+
+  ASSERT_EQ(array[0].ToUInt32(), 8000u & 4095u);
+  ASSERT_EQ(array[3].ToUInt32(), 600u);
+}
+
+TEST(StaticArrayViewTest, AccessTest) {
+  Array array(1 + 4 * 3 * 2);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>(i);
+  }
+  StaticArrayView<Array<>, 4, 3, 2> view(array, 1);
+
+  static_assert(sizeof(view) == sizeof(Array<>*) + sizeof(size_t));
+  static_assert(decltype(view)::kStrides[0] == 6 && decltype(view)::kStrides[1] == 2);
+  ASSERT_EQ(view[2][1][1].ToUInt32(), 1u + 2 * 6 + 1 * 2 + 1);
+  ASSERT_EQ(view(3u, 2u, 0u).ToUInt32(), 1u + 3 * 6 + 2 * 2);
+  view(0u, 0u, 1u) = 100u;
+  ASSERT_EQ(array[2].ToUInt32(), 100u);
+  ASSERT_ANY_THROW(view[4]);
+  ASSERT_ANY_THROW(view[0][3]);
+  ASSERT_ANY_THROW(view[0][0][2]);
+  ASSERT_ANY_THROW((StaticArrayView<Array<>, 6, 5>(array)));
+}
+
+TEST(StaticArrayViewTest, InteroperabilityTest) {
+  Array array1 = {1, 2, 3, 4, 5, 6};
+  Array array2 = {10, 20, 30, 40, 50, 60};
+  StaticArrayView<Array<>, 2, 3> static_view(array1);
+  ArrayWithVectorsView<2> dynamic_view(array2, 0, 2u, 3u);
+
+  ArrayView<2> converted = static_view.ToView();
+  ASSERT_EQ(converted.GetDimension(1), 3u);
+  ASSERT_EQ(converted[1][2].ToUInt32(), 6u);
+
+  dynamic_view += static_view;
+  ASSERT_EQ(array2[5].ToUInt32(), 66u);
+  static_view = dynamic_view - static_view * 2u;
+  ASSERT_EQ(array1[5].ToUInt32(), 54u);
+  ASSERT_ANY_THROW(ArrayWithVectorsView<2>(array2, 0, 3u, 2u) + static_view);
+}
+
+TEST(Array3DViewTest, StridesTest) {
+  Array array(2 + 2 * 3 * 4);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>(i);
+  }
+  ArrayView<3> view(array, 2, 2u, 3u, 4u);
+
+  ASSERT_EQ(view.GetStride(0), 12u);
+  ASSERT_EQ(view.GetStride(1), 4u);
+  ASSERT_EQ(view.GetStride(2), 1u);
+  ASSERT_EQ(view[1].GetStride(0), 4u);
+  for (size_t i = 0; i != 2; ++i) {
+    for (size_t j = 0; j != 3; ++j) {
+      for (size_t k = 0; k != 4; ++k) {
+        const auto expected = 2 + i * 12 + j * 4 + k;
+        ASSERT_EQ(view(i, j, k).ToUInt32(), expected);
+        ASSERT_EQ(view.Get(i, j, k).ToUInt32(), expected);
+        ASSERT_EQ(view[i][j][k].ToUInt32(), expected);
+      }
+    }
+  }
+  view(1u, 2u, 3u) = 7u;
+  ASSERT_EQ(array[25].ToUInt32(), 7u);
+
+  const ArrayView<3> const_view(array, 2, 2u, 3u, 4u);
+  ASSERT_EQ(const_view.Get(1u, 1u, 1u).ToUInt32(), 2u + 12 + 4 + 1);
+}
+
+TEST(Array2DViewTest, NonSquareGetTest) {
+  Array array = {1, 2, 3, 4, 5, 6};
+  ArrayView<2> view(array, 0, 2u, 3u);
+
+  ASSERT_EQ(view.Get(1u, 2u).ToUInt32(), 6u);
+  ASSERT_EQ(view(1u, 0u).ToUInt32(), 4u);
+  ASSERT_EQ(view[1](2).ToUInt32(), 6u);
+}
+
+TEST(StridedArrayViewTest, SliceTest) {
+  Array array(3 * 4 * 5);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>(i);
+  }
+  StridedArrayView<3> volume(ArrayView<3>(array, 0, 3u, 4u, 5u));
+
+  auto box = volume.Slice(1, 1, 4).Slice(2, 0, 5, 2);
+  ASSERT_EQ(box.GetDimension(0), 3u);
+  ASSERT_EQ(box.GetDimension(1), 3u);
+  ASSERT_EQ(box.GetDimension(2), 3u);
+  ASSERT_EQ(box(2u, 0u, 1u).ToUInt32(), 2u * 20 + 1 * 5 + 2);
+  ASSERT_EQ(box[1][2][2].ToUInt32(), 1u * 20 + 3 * 5 + 4);
+
+  auto reversed = volume.Reverse(2).Slice(0, 2, -1, -2);
+  ASSERT_EQ(reversed.GetDimension(0), 2u);
+  ASSERT_EQ(reversed(0u, 0u, 0u).ToUInt32(), 2u * 20 + 4);
+  ASSERT_EQ(reversed(1u, 3u, 4u).ToUInt32(), 3u * 5);
+
+  ASSERT_FALSE(box.IsContiguous());
+  ASSERT_TRUE(volume.Slice(0, 1, 2).IsContiguous());
+  ASSERT_THROW(volume.Slice(0, 0, 4), std::out_of_range);
+  ASSERT_THROW(volume.Slice(0, 0, 3, 0), std::invalid_argument);
+  ASSERT_EQ(volume.Slice(1, 2, 2).GetLength(), 0u);
+}
+
+TEST(StridedArrayViewTest, PermuteAndFixTest) {
+  Array array(3 * 4 * 5);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>(i);
+  }
+  StridedArrayView<3> volume(ArrayView<3>(array, 0, 3u, 4u, 5u));
+
+  auto transposed = volume.Transpose();
+  ASSERT_EQ(transposed.GetDimension(0), 5u);
+  ASSERT_EQ(transposed(4u, 1u, 2u).ToUInt32(), volume(2u, 1u, 4u).ToUInt32());
+
+  size_t axes[] = {1, 2, 0};
+  auto permuted = volume.Permute(axes);
+  ASSERT_EQ(permuted(3u, 4u, 2u).ToUInt32(), volume(2u, 3u, 4u).ToUInt32());
+  size_t wrong_axes[] = {1, 1, 0};
+  ASSERT_THROW(volume.Permute(wrong_axes), std::invalid_argument);
+
+  StridedArrayView<2> plane = volume.Fix(1, 2);
+  ASSERT_EQ(plane.GetDimension(0), 3u);
+  ASSERT_EQ(plane.GetDimension(1), 5u);
+  ASSERT_EQ(plane(1u, 3u).ToUInt32(), 1u * 20 + 2 * 5 + 3);
+  plane(2u, 4u) = 1000u;
+  ASSERT_EQ(array[2 * 20 + 2 * 5 + 4].ToUInt32(), 1000u);
+  ASSERT_THROW(volume.Fix(2, 5), std::out_of_range);
+
+  StridedArrayView<1> line = volume.Fix(0, 1).Fix(1, 3);
+  ASSERT_EQ(line.GetDimension(0), 4u);
+  ASSERT_EQ(line[2].ToUInt32(), 1u * 20 + 2 * 5 + 3);
+}
+
+TEST(StridedArrayViewTest, ForEachTest) {
+  Array array(3 * 4 * 5);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>(i);
+  }
+  StridedArrayView<3> volume(ArrayView<3>(array, 0, 3u, 4u, 5u));
+
+  std::vector<uint32_t> visited;
+  volume.Fix(2, 1).Transpose().ForEach([&](auto element) { visited.push_back(element.ToUInt32()); });
+
+  const std::vector<uint32_t> expected = {1, 21, 41, 6, 26, 46, 11, 31, 51, 16, 36, 56};
+  ASSERT_EQ(visited, expected);
+
+  size_t count = 0;
+  StridedArrayView<3, Array<>>(StaticArrayView<Array<>, 3, 4, 5>(array)).ForEach([&](auto) { ++count; });
+  ASSERT_EQ(count, 60u);
+}
+
+TEST(StridedArrayViewTest, BoundsTest) {
+  Array array(3 * 4 * 5);
+  const size_t dimensions[] = {3, 4};
+  const std::ptrdiff_t strides[] = {20, 5};
+  StridedArrayView<2> plane(array, 0, dimensions, strides);  // reaches offset 2 * 20 + 3 * 5 = 55
+  ASSERT_EQ(plane.GetLength(), 12u);
+  const std::ptrdiff_t reversed[] = {-20, 5};
+  ASSERT_NO_THROW(StridedArrayView<2>(array, 40, dimensions, reversed));
+  ASSERT_THROW(StridedArrayView<2>(array, 39, dimensions, reversed), std::out_of_range);  // reaches offset -1
+  ASSERT_THROW(StridedArrayView<2>(array, 5, dimensions, strides), std::out_of_range);  // reaches offset 60
+  const std::ptrdiff_t too_wide[] = {20, PTRDIFF_MAX / 2};
+  ASSERT_THROW(StridedArrayView<2>(array, 0, dimensions, too_wide), std::out_of_range);
+  ASSERT_THROW(StridedArrayView<2>(array, 60, dimensions, strides), std::out_of_range);
+  const size_t empty[] = {0, 4};
+  ASSERT_NO_THROW(StridedArrayView<2>(array, 60, empty, strides));  // reaches nothing
+}
+
+TEST(MappedArrayTest, FileRoundTripTest) {
+  const auto path = (std::filesystem::temp_directory_path() / "array3d_mapped_test.bin").string();
+  {
+    auto array = MappedArray<>::Create(path, 1000);
+    ASSERT_EQ(std::filesystem::file_size(path), 1000u * 17 / 8);
+    for (size_t i = 0; i != array.size(); ++i) {
+      array[i] = static_cast<uint32_t>(i * 100);
+    }
+    array.Sync();
+  }
+  {
+    const auto array = MappedArray<>::Open(path, 1000);
+    array.Advise(AccessPattern::kSequential);
+    ASSERT_FALSE(array.IsWritable());
+    ASSERT_EQ(array[999].ToUInt32(), 99900u);
+    std::vector<uint32_t> values(1000);
+    array.Unpack(0, values.size(), values.data());
+    ASSERT_EQ(values[500], 50000u);
+  }
+  {
+    auto array = MappedArray<>::Open(path, 400, MapMode::kReadWrite, 17 * 64);  // starts at number 512
+    ASSERT_EQ(array[0].ToUInt32(), 51200u);
+    array[1] = 7u;
+  }
+  ASSERT_EQ(MappedArray<>::Open(path, 1000)[513].ToUInt32(), 7u);
+  ASSERT_THROW(MappedArray<>::Open(path, 1001), std::out_of_range);
+  ASSERT_THROW(MappedArray<>::Open(path + ".missing", 1), std::system_error);
+  std::filesystem::remove(path);
+}
+
+TEST(MappedArrayTest, ViewsTest) {
+  MappedArray<> array(2 * 3 * 4);
+  for (size_t i = 0; i != array.size(); ++i) {
+    ASSERT_EQ(array[i].ToUInt32(), 0u);
+    array[i] = static_cast<uint32_t>(i);
+  }
+  array.Advise(AccessPattern::kRandom);
+  ArrayWithVectorsView<3, MappedArray<>> view(array, 0, 2u, 3u, 4u);
+
+  ASSERT_EQ(view[1][2][3].ToUInt32(), 23u);
+  view += view * 2u;
+  ASSERT_EQ(view[1][2][3].ToUInt32(), 69u);
+  auto [result, container] = (view + view).Evaluate();
+  ASSERT_EQ(result[1][0][0].ToUInt32(), 12u * 3 * 2);
+  delete container;
+  ASSERT_EQ(std::accumulate(array.begin(), array.end(), 0u), 276u * 3);
+}
+
+TEST(BinaryIOTest, RoundTripTest) {
+  Array array(2 * 3 * 5 + 1);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>(i * 4099 % 131072);
+  }
+  ArrayWithVectorsView<3> view(array, 1, 2u, 3u, 5u);  // starts at bit 17, re-packed while saving
+  std::stringstream stream;
+  binary::Save(stream, view);
+
+  ASSERT_EQ(stream.str().size(), binary::kFixedHeaderSize + 3 * 8 + (30 * 17 + 7) / 8);
+  binary::Header header;
+  auto loaded = binary::Load(stream, &header);
+  ASSERT_EQ(header.bit_length, 17u);
+  ASSERT_EQ(header.dimensions, (std::vector<size_t>{2, 3, 5}));
+  ASSERT_TRUE(header.has_checksum);
+  ArrayView<3> loaded_view(loaded, 0, header.dimensions.data());
+  ASSERT_TRUE(std::equal(loaded_view.begin(), loaded_view.end(), view.begin(), view.end()));
+
+  struct PipeBuffer : std::stringbuf {  // like a pipe or a socket, tellp() fails
+    pos_type seekoff(off_type, std::ios_base::seekdir, std::ios_base::openmode) override { return pos_type(-1); }
+    pos_type seekpos(pos_type, std::ios_base::openmode) override { return pos_type(-1); }
+  } pipe_buffer;
+  std::ostream pipe(&pipe_buffer);
+  binary::Save(pipe, view);  // the checksum is written with the header, nothing is patched in later
+  ASSERT_EQ(pipe_buffer.str(), stream.str());
+
+  std::stringstream aligned;
+  binary::Save(aligned, ArrayView<1>(array, 8, 20u), false);
+  auto line = binary::Load(aligned);
+  ASSERT_EQ(line.size(), 20u);
+  ASSERT_EQ(line[19].ToUInt32(), array[27].ToUInt32());
+}
+
+TEST(BinaryIOTest, ErrorsTest) {
+  Array array = {1, 2, 3};
+  std::stringstream stream;
+  binary::Save(stream, array);
+  auto bytes = stream.str();
+
+  std::stringstream wrong_width(bytes);
+  ASSERT_THROW(binary::Load<UIntNView<12>>(wrong_width), binary::FormatError);
+  bytes.back() ^= 1;
+  std::stringstream corrupted(bytes);
+  ASSERT_THROW(binary::Load(corrupted), binary::FormatError);
+  std::stringstream truncated(bytes.substr(0, bytes.size() - 1));
+  ASSERT_THROW(binary::Load(truncated), binary::FormatError);
+  std::stringstream garbage("not an array at all, definitely not");
+  ASSERT_THROW(binary::ReadHeader(garbage), binary::FormatError);
+
+  auto header = [](uint64_t length, std::initializer_list<uint64_t> dimensions) {
+    binary::Header result;
+    result.bit_length = 17;
+    result.length = length;
+    result.dimensions.assign(dimensions.begin(), dimensions.end());
+    const auto encoded = binary::detail::EncodeHeader(result);
+
+    return std::string(encoded.begin(), encoded.end());
+  };
+  std::stringstream wrapped(header(0, {uint64_t{1} << 33, uint64_t{1} << 31}));  // the product wraps to 0
+  ASSERT_THROW(binary::ReadHeader(wrapped), binary::FormatError);
+  std::stringstream too_long(header(uint64_t{1} << 62, {uint64_t{1} << 62}));  // length * 17 bits wraps
+  ASSERT_THROW(binary::ReadHeader(too_long), binary::FormatError);
+  std::stringstream huge(header(uint64_t{1} << 40, {uint64_t{1} << 20, uint64_t{1} << 20}) + "short data");
+  ASSERT_THROW(binary::Load(huge), binary::FormatError);  // rejected before allocating 2 TB
+}
+
+TEST(BinaryIOTest, MapTest) {
+  const auto path = (std::filesystem::temp_directory_path() / "array3d_binary_test.a3dv").string();
+  Array<UIntNView<12>> array = {10, 20, 30, 40, 50, 60};
+  binary::Save(path, ArrayView<2, Array<UIntNView<12>>>(array, 0, 2u, 3u));
+
+  binary::Header header;
+  auto mapped = binary::Map<UIntNView<12>>(path, &header);
+  ArrayView<2, MappedArray<UIntNView<12>>> view(mapped, 0, header.dimensions.data());
+  ASSERT_EQ(view[1][2].ToUInt32(), 60u);
+  ASSERT_EQ(binary::Load<UIntNView<12>>(path)[4].ToUInt32(), 50u);
+  std::filesystem::remove(path);
+}
+
+TEST(TextIOTest, RoundTripTest) {
+  Array array(3000);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>(i * 7919 % 131072);
+  }
+  ArrayWithVectorsView<2> view(array, 0, 30u, 100u);
+  std::stringstream stream;
+  stream << view;
+  auto text = stream.str();
+  ASSERT_EQ(text.substr(0, 12), "0 7919 15838");
+
+  Array copy(3000);
+  ArrayWithVectorsView<2> copy_view(copy, 0, 30u, 100u);
+  stream >> copy_view;
+  ASSERT_TRUE(stream.eof());
+  ASSERT_FALSE(stream.fail());
+  ASSERT_TRUE(std::equal(array.begin(), array.end(), copy.begin(), copy.end()));
+
+  Array from_memory(3000);
+  ASSERT_EQ(text::Read(text, from_memory, 0, 3000), text.size());
+  ASSERT_TRUE(std::equal(array.begin(), array.end(), from_memory.begin(), from_memory.end()));
+}
+
+TEST(TextIOTest, SeparatorsTest) {
+  Array array(4);
+  std::stringstream stream("  1,2\n3\t 4, 5");
+  text::Read(stream, ArrayView<1>(array));
+  ASSERT_EQ(array[3].ToUInt32(), 4u);
+  ASSERT_EQ(stream.peek(), ',');  // the rest of the input is left in the stream
+
+  std::stringstream csv;
+  text::Write(csv, array, 1, 3, ',');
+  ASSERT_EQ(csv.str(), "2,3,4");
+}
+
+TEST(TextIOTest, ErrorsTest) {
+  Array array(3);
+  ArrayWithVectorsView<1> view(array);
+
+  ASSERT_THROW(text::Read("1 2 131072", view), text::ParseError);
+  ASSERT_NO_THROW(text::Read("1 2 131071", view));
+  ASSERT_THROW(text::Read("1 2x 3", view), text::ParseError);
+  ASSERT_THROW(text::Read("1 -2 3", view), text::ParseError);
+  ASSERT_THROW(text::Read("1 99999999999999999999 3", view), text::ParseError);
+  auto message = [&](auto&& input) {  // of the ParseError thrown while reading input
+    try {
+      text::Read(input, view);
+    } catch (const text::ParseError& error) {
+      return std::string(error.what());
+    }
+    return std::string();
+  };
+  ASSERT_NE(message("1 abcdefghijklm 3").find("malformed"), std::string::npos);
+  ASSERT_NE(message("1 99999999999999999999 3").find("out of range"), std::string::npos);
+  ASSERT_NE(message("1 0000000000000000000x 3").find("malformed"), std::string::npos);
+  std::stringstream long_word("1 2 abcdefghijklmnopqrstuvwxyz");
+  ASSERT_NE(message(long_word).find("malformed number 'abcdefghijk...'"), std::string::npos);
+  std::stringstream long_number("1 2 000000000000999999999999");
+  ASSERT_NE(message(long_number).find("out of range"), std::string::npos);
+  try {
+    text::Read("1 2", view);
+    FAIL();
+  } catch (const text::ParseError& error) {
+    ASSERT_EQ(error.GetIndex(), 2u);
+  }
+
+  std::stringstream stream("5 6 200000");
+  stream >> view;
+  ASSERT_TRUE(stream.fail());
+  ASSERT_EQ(array[0].ToUInt32(), 1u);  // the failed block is not stored
+
+  ASSERT_NO_THROW(text::Read("000000000042 0 00000000000000000000131071", view));  // zero padded numbers fit
+  ASSERT_EQ(array[0].ToUInt32(), 42u);
+  ASSERT_EQ(array[2].ToUInt32(), 131071u);
+  std::stringstream padded("000000000042 000 00000000000000000000131071");
+  padded >> view;
+  ASSERT_FALSE(padded.fail());
+  ASSERT_EQ(array[0].ToUInt32(), 42u);
+  ASSERT_EQ(array[1].ToUInt32(), 0u);
+  ASSERT_EQ(array[2].ToUInt32(), 131071u);
+}
+
+TEST(ThreadPoolTest, ParallelForTest) {
+  ThreadPool pool(4);
+  ASSERT_EQ(pool.GetThreadCount(), 4u);
+  std::vector<std::atomic<int>> hits(1000);
+  for (int round = 0; round != 10; ++round) {
+    pool.ParallelFor(hits.size(), [&](size_t i) {
+      pool.ParallelFor(2, [&](size_t) { ++hits[i]; });  // nested calls run inline
+    });
+  }
+  ASSERT_TRUE(std::all_of(hits.begin(), hits.end(), [](const auto& hit) { return hit == 20; }));
+  ASSERT_THROW(pool.ParallelFor(100, [](size_t i) {
+    if (i == 42) {
+      throw std::runtime_error("task failed");
+    }
+  }), std::runtime_error);
+}
+
+TEST(ThreadPoolTest, ParallelEvaluateTest) {
+  ThreadPool pool(4);
+  const size_t length = 300001;
+  Array array(2 * length + 3);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>(i * 2654435761u);
+  }
+  ArrayWithVectorsView<1> a(array, 3, length);  // neither view starts on a group boundary
+  ArrayWithVectorsView<1> b(array, 3 + length, length);
+  auto [serial, serial_array] = (a + b * 3u - a * 5u).Evaluate();
+  auto [parallel, parallel_array] = (a + b * 3u - a * 5u).Evaluate(pool);
+  ASSERT_TRUE(std::equal(serial.begin(), serial.end(), parallel.begin(), parallel.end()));
+
+  auto [sum, sum_array] = (a + b).Evaluate();
+  (a + b).EvaluateInto(a, pool);
+  ASSERT_TRUE(std::equal(a.begin(), a.end(), sum.begin(), sum.end()));
+  delete serial_array;
+  delete parallel_array;
+  delete sum_array;
+}
+
+TEST(ThreadPoolTest, FillAndCopyTest) {
+  ThreadPool pool(3);
+  Array source(100003);
+  Array destination(100010);
+  parallel::Fill(ArrayView<1>(source, 0, source.size()), 77777u, pool);
+  ASSERT_TRUE(std::all_of(source.begin(), source.end(), [](uint32_t value) { return value == 77777u; }));
+  for (size_t i = 0; i < source.size(); i += 3) {
+    source[i] = static_cast<uint32_t>(i);
+  }
+  destination[4] = 1u;
+  destination[100008] = 2u;
+  parallel::Copy(ArrayView<1>(destination, 5, source.size()), ArrayView<1>(source), pool);
+  ASSERT_TRUE(std::equal(source.begin(), source.end(), destination.begin() + 5));
+  ASSERT_EQ(destination[4].ToUInt32(), 1u);
+  ASSERT_EQ(destination[100008].ToUInt32(), 2u);
+  ASSERT_THROW(parallel::Copy(ArrayView<1>(destination, 0, 5), ArrayView<1>(source, 0, 6), pool), std::logic_error);
+}
+
+TEST(AtomicUIntNViewTest, OperationsTest) {
+  Array array(64);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>(i);
+  }
+  for (size_t i = 0; i != array.size(); ++i) {  // every position inside and across 64-bit words
+    auto number = array.AtomicAt(i);
+    ASSERT_EQ(number.Load(), i);
+    ASSERT_EQ(number.FetchAdd(131072 - 1), i);
+    ASSERT_EQ(number.Load(), (i + 131071) % 131072);
+    number.Store(static_cast<uint32_t>(1000 + i));
+  }
+  for (size_t i = 0; i != array.size(); ++i) {
+    ASSERT_EQ(array[i].ToUInt32(), 1000 + i);
+  }
+
+  auto number = array.AtomicAt(3);
+  uint32_t expected = 5;
+  ASSERT_FALSE(number.CompareExchange(expected, 7));
+  ASSERT_EQ(expected, 1003u);
+  ASSERT_TRUE(number.CompareExchange(expected, 7));
+  ASSERT_EQ(array[3].ToUInt32(), 7u);
+  ASSERT_EQ(number.FetchSub(8), 7u);
+  ASSERT_EQ(array[3].ToUInt32(), 131071u);
+  ASSERT_EQ(array[2].ToUInt32(), 1002u);
+  ASSERT_EQ(array[4].ToUInt32(), 1004u);
+  ASSERT_THROW(array.AtomicAt(64), std::out_of_range);
+}
+
+TEST(AtomicUIntNViewTest, ConcurrentTest) {
+  const size_t length = 200;
+  const size_t rounds = 2000;
+  Array<AtomicUIntNView<17>> array(length);
+  for (auto&& number : array) {
+    number.SetToZero();
+  }
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t != 4; ++t) {
+    threads.emplace_back([&, t] {  // threads hammer adjacent numbers that share bytes and words
+      for (size_t round = 0; round != rounds; ++round) {
+        for (size_t i = t % 2; i < length; i += 2) {
+          array[i] += 1u;
+        }
+        for (size_t i = 0; i != length; ++i) {
+          uint32_t expected = array[i].Load();
+          while (!array[i].CompareExchange(expected, expected + 1)) {
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (size_t i = 0; i != length; ++i) {
+    ASSERT_EQ(array[i].ToUInt32(), 2 * rounds + 4 * rounds);
+  }
+
+  ArrayWithVectorsView<1, Array<AtomicUIntNView<17>>> view(array);
+  view += view;
+  ASSERT_EQ(array[7].ToUInt32(), 2u * 6 * rounds);
+}
+
+TEST(ReductionsTest, WholeViewTest) {
+  Array array(1 + 3 * 4 * 500);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>((i * 7919 + 13) % 131072);
+  }
+  ArrayWithVectorsView<3> view(array, 1, 3u, 4u, 500u);
+  std::vector<uint32_t> values(view.begin(), view.end());
+
+  ASSERT_EQ(Sum(view), std::accumulate(values.begin(), values.end(), uint64_t{0}));
+  const auto min = Min(view);
+  const auto max = Max(view);
+  ASSERT_EQ(min.value, *std::min_element(values.begin(), values.end()));
+  ASSERT_EQ(min.position, static_cast<size_t>(std::min_element(values.begin(), values.end()) - values.begin()));
+  ASSERT_EQ(max.value, *std::max_element(values.begin(), values.end()));
+  ASSERT_EQ(max.position, static_cast<size_t>(std::max_element(values.begin(), values.end()) - values.begin()));
+  ASSERT_EQ(Dot(view, view), std::inner_product(values.begin(), values.end(), values.begin(), uint64_t{0},
+                                                 std::plus<>(), [](uint64_t a, uint64_t b) { return a * b; }));
+
+  const auto histogram = Histogram(view);
+  ASSERT_EQ(histogram.size(), 131072u);
+  ASSERT_EQ(histogram[values[5]], static_cast<uint64_t>(std::count(values.begin(), values.end(), values[5])));
+  ASSERT_EQ(std::accumulate(histogram.begin(), histogram.end(), uint64_t{0}), values.size());
+
+  ASSERT_THROW(Min(ArrayView<1>(array, 0, size_t{0})), std::invalid_argument);
+  ASSERT_THROW(Dot(view, ArrayView<3>(array, 0, 4u, 3u, 500u)), std::logic_error);
+}
+
+TEST(ReductionsTest, AlongAxisTest) {
+  Array array(2 * 3 * 700);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>((i * 31 + 7) % 1000);
+  }
+  ArrayView<3> view(array, 0, 2u, 3u, 700u);
+  for (size_t axis = 0; axis != 3; ++axis) {
+    const auto sums = SumAlongAxis(view, axis);
+    auto [mins, min_array] = MinAlongAxis(view, axis);
+    auto [maxs, max_array] = MaxAlongAxis(view, axis);
+    ASSERT_EQ(sums.size(), view.GetLength() / view.GetDimension(axis));
+    ASSERT_EQ(mins.GetLength(), sums.size());
+    size_t position = 0;
+    for (size_t i = 0; i != 2; ++i) {
+      for (size_t j = 0; j != 3; ++j) {
+        for (size_t k = 0; k != 700; ++k) {
+          if ((axis == 0 && i != 0) || (axis == 1 && j != 0) || (axis == 2 && k != 0)) {
+            continue;
+          }
+          uint64_t sum = 0;
+          uint32_t min = UINT32_MAX;
+          uint32_t max = 0;
+          for (size_t t = 0; t != view.GetDimension(axis); ++t) {
+            const auto value = (axis == 0) ? view(t, j, k) : (axis == 1) ? view(i, t, k) : view(i, j, t);
+            sum += value;
+            min = std::min(min, value.ToUInt32());
+            max = std::max(max, value.ToUInt32());
+          }
+          ASSERT_EQ(sums[position], sum);
+          ASSERT_EQ(min_array->At(position).ToUInt32(), min);
+          ASSERT_EQ(max_array->At(position).ToUInt32(), max);
+          ++position;
+        }
+      }
+    }
+    ASSERT_EQ(position, sums.size());
+    delete min_array;
+    delete max_array;
+  }
+  ASSERT_THROW(SumAlongAxis(view, 3), std::out_of_range);
+}
+
+TEST(ArrayHandleTest, OwnershipTest) {
+  Array a = {1, 2, 3, 4};
+  Array b = {10, 20, 30, 40};
+  ArrayWithVectorsView<2> x(a, 0, 2u, 2u);
+  ArrayWithVectorsView<2> y(b, 0, 2u, 2u);
+
+  ArrayHandle sum((x + y * 2u).Evaluate());
+  ASSERT_EQ(sum[1][1].ToUInt32(), 84u);
+  ArrayHandle<2> moved = std::move(sum);
+  ASSERT_EQ(moved(1u, 0u).ToUInt32(), 63u);
+  auto moved_view = moved.GetView();
+  moved_view += x;
+  ASSERT_EQ(moved[0][0].ToUInt32(), 22u);
+
+  ArrayHandle made(ArrayView<3>::MakeArray(2u, 3u, 4u));
+  static_assert(std::is_same_v<decltype(made), ArrayHandle<3>>);
+  ASSERT_EQ(made.GetLength(), 24u);
+  auto created = ArrayHandle<1>::Make(5u);
+  created[4] = 7u;
+  ASSERT_EQ(created.GetContainer()[4].ToUInt32(), 7u);
+  ASSERT_THROW((ArrayHandle<2>(std::make_unique<Array<>>(3), 0, std::vector<size_t>{2, 2}.data())), std::out_of_range);
+}
+
+TEST(ArrayHandleTest, BufferPoolTest) {
+  ASSERT_EQ(BufferPool::ClassSize(1), 64u);
+  ASSERT_EQ(BufferPool::ClassSize(1000), 1024u);
+  ASSERT_EQ(BufferPool::ClassSize(1025), 1280u);
+  ASSERT_GE(BufferPool::ClassSize(3000000), 3000000u);
+
+  BufferPool pool;
+  Array a = {1, 2, 3};
+  Array b = {4, 5, 6};
+  ArrayWithVectorsView<1> x(a);
+  ArrayWithVectorsView<1> y(b);
+  for (int frame = 0; frame != 5; ++frame) {
+    auto volume = ArrayHandle<3>::Make(pool, 10u, 10u, 10u);
+    volume.GetView()(9u, 9u, 9u) = 5u;
+    auto result = Evaluate(x + y, pool);
+    ASSERT_EQ(result[2].ToUInt32(), 9u);
+    Array copy(volume.GetContainer());  // copies draw from the same pool
+    ASSERT_EQ(copy[999].ToUInt32(), 5u);
+  }
+  ASSERT_EQ(pool.GetReusedCount(), 3u * 4);
+  ASSERT_GT(pool.GetCachedBytes(), 0u);
+  pool.Reset();
+  ASSERT_EQ(pool.GetCachedBytes(), 0u);
+  Array pooled(100, pool);
+  Array moved(std::move(pooled));
+  ASSERT_EQ(moved.size(), 100u);
+}
+
+TEST(ArrayTest, AllocationTest) {
+  Array zeros(1000, Initialization::kZero);
+  ASSERT_TRUE(std::all_of(zeros.begin(), zeros.end(), [](uint32_t value) { return value == 0; }));
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(zeros.Data()) % utils::kCacheLineSize, 0u);
+  zeros[999] = 131071u;  // the last number is read with a word load reaching into the tail slack
+  ASSERT_EQ(zeros[999].ToUInt32(), 131071u);
+  ASSERT_EQ(zeros[998].ToUInt32(), 0u);
+
+  BufferPool pool;
+  Array<UIntNView<32>> pooled(33, pool, Initialization::kZero);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(pooled.Data()) % utils::kCacheLineSize, 0u);
+  pooled[32] = 0xFFFFFFFFu;
+  ASSERT_EQ(pooled[32].ToUInt32(), 0xFFFFFFFFu);
+  ASSERT_EQ(pooled[31].ToUInt32(), 0u);
+
+  uint8_t bytes[4 + packing::kTailSlack] = {0xAB, 0x00, 0x00, 0xCD};
+  UIntNView<17> number(bytes, 4);  // spans bits 4..20, bytes 0..2
+  number = 131071u;
+  ASSERT_EQ(bytes[0], 0xAF);
+  ASSERT_EQ(bytes[2] & 0x07, 0x00);
+  ASSERT_EQ(bytes[3], 0xCD);  // the masked store leaves bytes outside the number alone
+}
+
+TEST(ArrayTest, CopyOnWriteTest) {
+  Array array(1000, Initialization::kZero);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>(i * 131);
+  }
+  Array eager(array);
+  ASSERT_TRUE(std::equal(array.cbegin(), array.cend(), eager.cbegin(), eager.cend()));
+  ASSERT_NE(std::as_const(eager).Data(), std::as_const(array).Data());
+
+  array.SetCopyPolicy(CopyPolicy::kCopyOnWrite);
+  const Array shared(array);
+  Array writer = array;
+  ASSERT_EQ(writer.GetCopyPolicy(), CopyPolicy::kCopyOnWrite);
+  ASSERT_TRUE(array.IsShared());
+  ASSERT_EQ(std::as_const(writer).Data(), shared.Data());
+  ASSERT_EQ(shared[999].ToUInt32(), 999u * 131);
+
+  writer[5] = 7u;  // the first write gives writer a buffer of its own
+  ASSERT_FALSE(writer.IsShared());
+  ASSERT_NE(std::as_const(writer).Data(), shared.Data());
+  ASSERT_EQ(writer[5].ToUInt32(), 7u);
+  ASSERT_EQ(shared[5].ToUInt32(), 5u * 131);
+  ASSERT_EQ(std::as_const(array)[5].ToUInt32(), 5u * 131);
+  ASSERT_TRUE(std::equal(writer.cbegin() + 6, writer.cend(), shared.cbegin() + 6, shared.cend()));
+
+  {
+    Array reader(array);  // reads through a view over a const container keep the buffer shared
+    ArrayView<3, const Array<>> volume(reader, 0, 10u, 10u, 10u);
+    ASSERT_EQ(volume[1][2][3].ToUInt32(), 123u * 131);
+    ASSERT_EQ(volume(9u, 9u, 9u).ToUInt32(), 999u * 131);
+    ASSERT_EQ(std::accumulate(volume.begin(), volume.end(), uint64_t{0}), uint64_t{131} * 999 * 1000 / 2);
+    ASSERT_TRUE(reader.IsShared());
+
+    auto handle = array[7];  // a writable view taken before a copy must not write into it
+    Array eager_again(array);
+    ASSERT_NE(std::as_const(eager_again).Data(), std::as_const(array).Data());
+    handle = 1u;
+    ASSERT_EQ(eager_again[7].ToUInt32(), 7u * 131);
+    ASSERT_EQ(eager_again.GetCopyPolicy(), CopyPolicy::kCopyOnWrite);
+    handle = 7u * 131;
+    array.SetCopyPolicy(CopyPolicy::kCopyOnWrite);  // handle is not used anymore
+    Array shared_again(array);
+    ASSERT_EQ(std::as_const(shared_again).Data(), std::as_const(array).Data());
+  }
+
+  array.SetCopyPolicy(CopyPolicy::kEager);
+  ASSERT_FALSE(shared.IsShared());
+  array[0] = 1u;
+  ASSERT_EQ(shared[0].ToUInt32(), 0u);
+
+  BufferPool pool;
+  Array pooled(100, pool, Initialization::kZero);
+  pooled.SetCopyPolicy(CopyPolicy::kCopyOnWrite);
+  {
+    Array copy(pooled);
+    copy.Pack(std::vector<uint32_t>(100, 3u).data(), 0, 100);
+    ASSERT_EQ(copy[99].ToUInt32(), 3u);
+    ASSERT_EQ(pooled[99].ToUInt32(), 0u);
+  }
+  ASSERT_EQ(pool.GetCachedBytes(), BufferPool::ClassSize(256));
+}
+
+TEST(ArrayTest, CopyOnWriteParallelTest) {
+  ThreadPool pool(4);
+  const size_t length = 100003;
+  Array array(length);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>(i * 2654435761u);
+  }
+  array.SetCopyPolicy(CopyPolicy::kCopyOnWrite);
+  const auto& original = array;  // reads through operator[] of a non-const array would make copies eager
+
+  Array copy(array);  // the pool threads must not each detach the shared buffer
+  ArrayWithVectorsView<1> destination(copy);
+  ASSERT_TRUE(copy.IsShared());
+  (destination + destination).EvaluateInto(destination, pool);
+  ASSERT_FALSE(copy.IsShared());
+  for (size_t i = 0; i != length; ++i) {
+    ASSERT_EQ(copy[i].ToUInt32(), (original[i].ToUInt32() * 2) % 131072);
+  }
+
+  Array filled(array);
+  ASSERT_TRUE(filled.IsShared());
+  parallel::Fill(ArrayView<1>(filled), 5u, pool);
+  ASSERT_EQ(std::count(filled.cbegin(), filled.cend(), 5u), static_cast<ptrdiff_t>(length));
+  ASSERT_EQ(original[1].ToUInt32(), 2654435761u % 131072);
+
+  Array counters(array);
+  ASSERT_THROW(counters.AtomicAt(0), std::logic_error);
+  counters.PrepareForWrite();
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t != 4; ++t) {
+    threads.emplace_back([&] {
+      for (size_t i = 0; i != 1000; ++i) {
+        counters.AtomicAt(i).FetchAdd(1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (size_t i = 0; i != 1000; ++i) {
+    ASSERT_EQ(counters[i].ToUInt32(), (original[i].ToUInt32() + 4) % 131072);
+  }
+}
+
+TEST(ArrayTest, LazyZeroTest) {
+  auto [volume, array] = ArrayView<3>::MakeLazyZeroArray(256u, 256u, 256u);  // 34 MB of address space
+  ASSERT_TRUE(array->IsLazyZero());
+  ASSERT_LT(array->ResidentBytes(), 1u << 20);
+  volume(0, 0, 3) = 5u;
+  volume(100, 7, 9) = 131071u;
+  volume(255, 255, 255) = 1u;
+  const auto touched = array->ResidentBytes();
+  ASSERT_GT(touched, 0u);
+  ASSERT_LT(touched, 1u << 20);
+
+  ASSERT_FALSE(array->IsZeroRegion(0, 4));
+  ASSERT_TRUE(array->IsZeroRegion(4, 100 * 65536 + 7 * 256 + 9 - 4));
+  ASSERT_FALSE(array->IsZeroRegion(5, 100 * 65536 + 7 * 256 + 9 - 4));
+  ASSERT_TRUE(array->IsZeroRegion(volume.GetLength() - 9, 8));
+  ASSERT_FALSE(array->IsZeroRegion(volume.GetLength() - 1, 1));
+  ASSERT_TRUE(array->IsZeroRegion(volume.GetLength(), 0));
+  ASSERT_THROW(static_cast<void>(array->IsZeroRegion(volume.GetLength(), 1)), std::out_of_range);
+  ASSERT_EQ(array->ResidentBytes(), touched);  // pages never written are not read
+
+  Array copy(*array);  // copies only the pages holding numbers
+  ASSERT_TRUE(copy.IsLazyZero());
+  ASSERT_EQ(copy[100 * 65536 + 7 * 256 + 9].ToUInt32(), 131071u);
+  ASSERT_EQ(copy[volume.GetLength() - 1].ToUInt32(), 1u);
+  ASSERT_LE(copy.ResidentBytes(), touched);
+  ASSERT_EQ(array->ResidentBytes(), touched);
+
+  volume(100, 7, 9) = 0u;
+  volume(255, 255, 255) = 0u;
+  // the pages of both numbers and the slack page the word store of the last number reaches into
+  ASSERT_EQ(array->Compact(), 3u);
+  ASSERT_LT(array->ResidentBytes(), touched);
+  ASSERT_EQ(array->Compact(), 0u);
+  ASSERT_EQ(volume(0, 0, 3).ToUInt32(), 5u);
+  ASSERT_TRUE(array->IsZeroRegion(4, volume.GetLength() - 4));
+  volume(255, 255, 255) = 2u;  // a released page is mapped again on write
+  ASSERT_EQ(volume(255, 255, 255).ToUInt32(), 2u);
+
+  Array dense(1000, Initialization::kZero);
+  ASSERT_FALSE(dense.IsLazyZero());
+  ASSERT_EQ(dense.Compact(), 0u);
+  ASSERT_TRUE(dense.IsZeroRegion(0, 1000));
+  BufferPool pool;
+  ASSERT_THROW(Array(10, pool, Initialization::kLazyZero), std::invalid_argument);
+  delete array;
+}
+
+TEST(BrickedArrayTest, ConversionTest) {
+  auto [view, array] = ArrayView<3>::MakeArray(5u, 9u, 17u);
+  for (size_t i = 0; i != array->size(); ++i) {
+    (*array)[i] = static_cast<uint32_t>(i * 37 % 131072);
+  }
+  auto bricked = BrickedArray<>::FromRowMajor(view);
+  ASSERT_EQ(bricked.GetLength(), 5u * 9u * 17u);
+  ASSERT_EQ(bricked.GetContainer().size(), 1u * 2u * 3u * 512u);
+  for (size_t i = 0; i != 5; ++i) {
+    for (size_t j = 0; j != 9; ++j) {
+      for (size_t k = 0; k != 17; ++k) {
+        ASSERT_EQ(bricked(i, j, k).ToUInt32(), view(i, j, k).ToUInt32());
+      }
+    }
+  }
+  ASSERT_EQ(bricked[4][8][16].ToUInt32(), view[4][8][16].ToUInt32());
+  ASSERT_EQ(bricked.Offset(0, 0, 8), 512u);
+  ASSERT_EQ(bricked.Offset(1, 0, 0), 64u);
+
+  bricked[2][3][4] = 100u;
+  bricked(4, 8, 16) += 1u;
+  auto [result, result_array] = bricked.ToRowMajor();
+  ASSERT_EQ(result(2, 3, 4).ToUInt32(), 100u);
+  ASSERT_EQ(result(4, 8, 16).ToUInt32(), view(4, 8, 16).ToUInt32() + 1);
+  ASSERT_EQ(result(0, 1, 2).ToUInt32(), view(0, 1, 2).ToUInt32());
+
+  ASSERT_THROW(bricked[5], std::out_of_range);
+  ASSERT_THROW(bricked[0][9], std::out_of_range);
+  ASSERT_THROW(std::as_const(bricked)[0][0][17], std::out_of_range);
+  ASSERT_THROW(bricked.ToRowMajor(ArrayView<3>(*array, 0, 5u, 17u, 9u)), std::logic_error);
+  delete array;
+  delete result_array;
+}
+
+namespace {
+
+// v[i][j][k] per neighbour, as stencils were written before ApplyStencil
+uint32_t NaiveStencil(const ArrayView<3>& view, size_t i, size_t j, size_t k, const Stencil& stencil, Boundary boundary) {
+  const size_t indices[] = {i, j, k};
+  int32_t sum = 0;
+  for (int di = -1; di <= 1; ++di) {
+    for (int dj = -1; dj <= 1; ++dj) {
+      for (int dk = -1; dk <= 1; ++dk) {
+        const int offsets[] = {di, dj, dk};
+        size_t neighbour[3];
+        bool outside = false;
+        for (size_t axis = 0; axis != 3; ++axis) {
+          const auto length = static_cast<int64_t>(view.GetDimension(axis));
+          auto index = static_cast<int64_t>(indices[axis]) + offsets[axis];
+          if (index < 0 || index >= length) {
+            outside = (boundary == Boundary::kZero);
+            index = (boundary == Boundary::kWrap) ? (index + length) % length : std::clamp<int64_t>(index, 0, length - 1);
+          }
+          neighbour[axis] = static_cast<size_t>(index);
+        }
+        if (!outside) {
+          sum += stencil.weights[di + 1][dj + 1][dk + 1] *
+                 static_cast<int32_t>(view[neighbour[0]][neighbour[1]][neighbour[2]].ToUInt32());
+        }
+      }
+    }
+  }
+
+  return static_cast<uint32_t>(sum / stencil.divisor) & ((1u << 17) - 1);
+}
+
+}  // namespace
+
+TEST(StencilTest, BoundariesTest) {
+  auto [input, input_array] = ArrayView<3>::MakeArray(4u, 5u, 19u);
+  auto [output, output_array] = ArrayView<3>::MakeArray(4u, 5u, 19u);
+  for (size_t i = 0; i != input_array->size(); ++i) {
+    (*input_array)[i] = static_cast<uint32_t>(i * 7919 % 1000);
+  }
+  const Stencil stencils[] = {Stencil::SevenPoint(-6, 1), Stencil::TwentySevenPoint(8, 4, 2, 1, 64),
+                              Stencil::TwentySevenPoint(0, 1, 1, 1)};
+  for (const auto& stencil : stencils) {
+    for (const auto boundary : {Boundary::kClamp, Boundary::kZero, Boundary::kWrap}) {
+      ApplyStencil(input, output, stencil, boundary);
+      for (size_t i = 0; i != 4; ++i) {
+        for (size_t j = 0; j != 5; ++j) {
+          for (size_t k = 0; k != 19; ++k) {
+            ASSERT_EQ(output(i, j, k).ToUInt32(), NaiveStencil(input, i, j, k, stencil, boundary));
+          }
+        }
+      }
+    }
+  }
+  ASSERT_THROW(ApplyStencil(input, ArrayView<3>(*output_array, 0, 5u, 4u, 19u), stencils[0]), std::logic_error);
+  ASSERT_THROW(Stencil::SevenPoint(1, 1, 0), std::invalid_argument);
+  delete input_array;
+  delete output_array;
+}
+
+TEST(StencilTest, InPlaceTest) {
+  auto [volume, array] = ArrayWithVectorsView<3>::MakeArray(6u, 3u, 10u);
+  for (size_t i = 0; i != array->size(); ++i) {
+    (*array)[i] = static_cast<uint32_t>(i * 31 % 257);
+  }
+  const auto stencil = Stencil::TwentySevenPoint(2, 1, 1, 1, 28);
+  for (const auto boundary : {Boundary::kClamp, Boundary::kWrap}) {
+    Array before(*array);
+    ArrayView<3> before_view(before, 0, 6u, 3u, 10u);
+    ApplyStencil(volume, volume, stencil, boundary);
+    for (size_t i = 0; i != 6; ++i) {
+      for (size_t j = 0; j != 3; ++j) {
+        for (size_t k = 0; k != 10; ++k) {
+          ASSERT_EQ(volume(i, j, k).ToUInt32(), NaiveStencil(before_view, i, j, k, stencil, boundary));
+        }
+      }
+    }
+  }
+  delete array;
+}
+
+TEST(BroadcastTest, PlaneAndColumnTest) {
+  auto [volume, volume_array] = ArrayWithVectorsView<3>::MakeArray(3u, 4u, 5u);
+  auto [plane, plane_array] = ArrayWithVectorsView<2>::MakeArray(4u, 5u);
+  auto [column, column_array] = ArrayWithVectorsView<3>::MakeArray(3u, 4u, 1u);
+  for (size_t i = 0; i != volume_array->size(); ++i) {
+    (*volume_array)[i] = static_cast<uint32_t>(1000 + i);
+  }
+  for (size_t i = 0; i != plane_array->size(); ++i) {
+    (*plane_array)[i] = static_cast<uint32_t>(i);
+  }
+  for (size_t i = 0; i != column_array->size(); ++i) {
+    (*column_array)[i] = static_cast<uint32_t>(i + 1);
+  }
+
+  auto [sum, sum_array] = (volume + plane).Evaluate();
+  auto [difference, difference_array] = (volume - column * 2u).Evaluate();
+  auto [product, product_array] = (column * volume).Evaluate();
+  ASSERT_EQ(product.GetDimension(2), 5u);
+  for (size_t i = 0; i != 3; ++i) {
+    for (size_t j = 0; j != 4; ++j) {
+      for (size_t k = 0; k != 5; ++k) {
+        const auto value = volume(i, j, k).ToUInt32();
+        ASSERT_EQ(sum(i, j, k).ToUInt32(), value + plane(j, k).ToUInt32());
+        ASSERT_EQ(difference(i, j, k).ToUInt32(), value - 2 * column(i, j, 0u).ToUInt32());
+        ASSERT_EQ(product(i, j, k).ToUInt32(), value * column(i, j, 0u).ToUInt32());
+      }
+    }
+  }
+
+  volume += plane;
+  ASSERT_EQ(volume(2u, 3u, 4u).ToUInt32(), 1000u + 59u + 19u);
+  volume *= column;
+  ASSERT_EQ(volume(2u, 3u, 4u).ToUInt32(), (1000u + 59u + 19u) * 12u);
+  ASSERT_THROW(column += volume, std::logic_error);  // the destination is not broadcast
+  auto [wrong, wrong_array] = ArrayWithVectorsView<2>::MakeArray(4u, 4u);
+  ASSERT_THROW(volume + wrong, std::logic_error);
+  delete volume_array;
+  delete plane_array;
+  delete column_array;
+  delete sum_array;
+  delete difference_array;
+  delete product_array;
+  delete wrong_array;
+}
+
+TEST(BroadcastTest, OuterTest) {
+  Array rows_array = {1, 2, 3};
+  Array columns_array = {10, 20, 30, 40};
+  ArrayWithVectorsView<2> rows(rows_array, 0, 3u, 1u);
+  ArrayWithVectorsView<1> columns(columns_array, 0, 4u);
+  auto [outer, outer_array] = (rows * columns + rows).Evaluate();
+  ASSERT_EQ(outer.GetDimension(0), 3u);
+  ASSERT_EQ(outer.GetDimension(1), 4u);
+  for (size_t i = 0; i != 3; ++i) {
+    for (size_t j = 0; j != 4; ++j) {
+      ASSERT_EQ(outer(i, j).ToUInt32(), (i + 1) * (j + 1) * 10 + (i + 1));
+    }
+  }
+
+  ThreadPool pool(4);
+  auto [big, big_array] = ArrayWithVectorsView<3>::MakeArray(64u, 64u, 64u);
+  std::fill(big_array->begin(), big_array->end(), 7u);
+  auto [row, row_array] = ArrayWithVectorsView<1>::MakeArray(64u);
+  std::iota(row_array->begin(), row_array->end(), 0u);
+  auto [parallel_sum, parallel_array] = (big + row * 2u).Evaluate(pool);
+  for (size_t n = 0; n < parallel_array->size(); n += 997) {
+    ASSERT_EQ((*parallel_array)[n].ToUInt32(), 7u + n % 64 * 2);
+  }
+  delete outer_array;
+  delete big_array;
+  delete row_array;
+  delete parallel_array;
+}
+
+TEST(BroadcastTest, AliasedOperandTest) {
+  ThreadPool pool(4);
+  for (const size_t rows : {5u, 40u}) {  // a plane within one block and a plane of several blocks
+    auto [volume, array] = ArrayWithVectorsView<3>::MakeArray(3u, rows, 50u);
+    std::fill(volume.begin(), volume.end(), 1u);
+    ArrayWithVectorsView<2> plane(*array, 0, rows, 50u);
+    volume += plane;  // plane 0 is doubled too, the other planes must still add the old 1
+    ASSERT_TRUE(std::all_of(volume.begin(), volume.end(), [](uint32_t value) { return value == 2; }));
+    (volume * plane).EvaluateInto(volume, pool);
+    ASSERT_TRUE(std::all_of(volume.begin(), volume.end(), [](uint32_t value) { return value == 4; }));
+    delete array;
+  }
+
+  Array array(1000);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>(i);
+  }
+  ArrayWithVectorsView<1> head(array, 0, 999);
+  ArrayWithVectorsView<1> shifted(array, 1, 999);
+  head = shifted + shifted;
+  for (size_t i = 0; i != 999; ++i) {
+    ASSERT_EQ(array[i].ToUInt32(), 2 * (i + 1));
+  }
+}
+
+TEST(CompressedArrayTest, RoundTripTest) {
+  Array array(1000, Initialization::kZero);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>(50000 + (i * 37) % 300);  // 9-bit differences
+  }
+  array[900] = 131071u;  // one wide block
+  const auto compressed = CompressedArray<17>::From(array);
+  ASSERT_EQ(compressed.size(), 1000u);
+  ASSERT_EQ(compressed.GetWidth(0), 9u);
+  ASSERT_EQ(compressed.GetWidth(900), 17u);
+  ASSERT_LT(compressed.SizeInBytes(), array.SizeInBytes());
+  std::vector<uint32_t> decoded(1000);
+  compressed.Unpack(0, 1000, decoded.data());
+  for (size_t i = 0; i != array.size(); ++i) {
+    ASSERT_EQ(compressed[i].ToUInt32(), array[i].ToUInt32());
+    ASSERT_EQ(decoded[i], array[i].ToUInt32());
+  }
+  compressed.Unpack(130, 3, decoded.data());
+  ASSERT_EQ(decoded[2], array[132].ToUInt32());
+
+  Array<UIntNView<20>> wide(300);  // numbers of a wider source keep their low 17 bits
+  for (size_t i = 0; i != wide.size(); ++i) {
+    wide[i] = static_cast<uint32_t>((i % 3) * 400000 + i);
+  }
+  const auto narrowed = CompressedArray<17>::From(wide);
+  for (size_t i = 0; i != wide.size(); ++i) {
+    ASSERT_EQ(narrowed[i].ToUInt32(), wide[i].ToUInt32() % 131072);
+  }
+
+  CompressedArray<17> zeros(300);
+  ASSERT_EQ(zeros.SizeInBytes(), 3 * 16u);
+  ASSERT_EQ(zeros[299].ToUInt32(), 0u);
+  ASSERT_THROW(zeros.At(300), std::out_of_range);
+}
+
+TEST(CompressedArrayTest, WriteTest) {
+  CompressedArray<17> compressed(1000);
+  compressed[5] = 3u;  // widens block 0, the following blocks move
+  compressed[200] = 100000u;
+  compressed[6] = 1u;  // fits into the width of block 0
+  ASSERT_EQ(compressed.GetWidth(0), 2u);
+  ASSERT_EQ(compressed[5].ToUInt32(), 3u);
+  ASSERT_EQ(compressed[6].ToUInt32(), 1u);
+  ASSERT_EQ(compressed[200].ToUInt32(), 100000u);
+  ASSERT_EQ(compressed[201].ToUInt32(), 0u);
+  compressed[5] = 0u;
+  compressed[6] = 0u;
+  compressed[7] = 131072u + 4;  // overflow ignored
+  ASSERT_EQ(compressed[7].ToUInt32(), 4u);
+  ASSERT_EQ(compressed[200].ToUInt32(), 100000u);
+
+  std::vector<uint32_t> values(300);
+  std::iota(values.begin(), values.end(), 7u);
+  compressed.Pack(values.data(), 100, 300);
+  for (size_t i = 0; i != 300; ++i) {
+    ASSERT_EQ(compressed[100 + i].ToUInt32(), 7u + i);
+  }
+  ASSERT_EQ(compressed[7].ToUInt32(), 4u);
+  ASSERT_EQ(compressed[400].ToUInt32(), 0u);
+
+  ArrayWithVectorsView<2, CompressedArray<17>> view(compressed, 100, 10u, 30u);
+  view *= 2u;
+  ASSERT_EQ(view(9u, 29u).ToUInt32(), 2 * (7u + 299));
+  ASSERT_EQ(std::as_const(view)(0u, 1u).ToUInt32(), 16u);
+}
+
+TEST(CompressedArrayTest, ParallelTest) {
+  ThreadPool pool(4);
+  const size_t length = 1 << 20;
+  CompressedArray<17> compressed(length);
+  ArrayWithVectorsView<1, CompressedArray<17>> view(compressed, 0, length);
+  parallel::Fill(view, 3u, pool);  // kWriteAlignment is 0, stores run on one thread
+  for (size_t i = 0; i < length; i += 1001) {
+    compressed[i] = static_cast<uint32_t>(i % 131072);
+  }
+  auto [sum, sum_array] = (view + view).Evaluate(pool);
+  (view + view).EvaluateInto(view, pool);
+  for (size_t i = 0; i < length; i += 7) {
+    const auto expected = (i % 1001 == 0) ? static_cast<uint32_t>(2 * (i % 131072) % 131072) : 6u;
+    ASSERT_EQ(sum[i].ToUInt32(), expected);
+    ASSERT_EQ(compressed[i].ToUInt32(), expected);
+  }
+  delete sum_array;
+}
+
+TEST(BitSlicedArrayTest, ConversionTest) {
+  Array array(200, Initialization::kZero);
+  for (size_t i = 0; i != array.size(); ++i) {
+    array[i] = static_cast<uint32_t>(i * 977 % 131072);
+  }
+  auto sliced = BitSlicedArray<17>::From(array);
+  ASSERT_EQ(sliced.size(), 200u);
+  ASSERT_EQ(sliced.SizeInBytes(), 4 * 17 * sizeof(uint64_t));
+  for (size_t i = 0; i != array.size(); ++i) {
+    ASSERT_EQ(sliced[i].ToUInt32(), array[i].ToUInt32());
+  }
+  sliced[130] = 131071u;
+  sliced[131] += 1u;
+  const auto back = sliced.ToArray();
+  ASSERT_EQ(back[130].ToUInt32(), 131071u);
+  ASSERT_EQ(back[131].ToUInt32(), array[131].ToUInt32() + 1);
+  ASSERT_EQ(back[199].ToUInt32(), array[199].ToUInt32());
+
+  ArrayView<2, BitSlicedArray<17>> view(sliced, 0, 10u, 20u);
+  ASSERT_EQ(view(3u, 4u).ToUInt32(), array[64].ToUInt32());
+}
+
+TEST(BitSlicedArrayTest, PredicatesTest) {
+  std::vector<uint32_t> values(150);
+  for (size_t i = 0; i != values.size(); ++i) {
+    values[i] = static_cast<uint32_t>(i * 7919 % 1000);
+  }
+  BitSlicedArray<17> sliced(values.size());
+  sliced.Pack(values.data(), 0, values.size());
+  const auto count = [&](auto predicate) {
+    return static_cast<size_t>(std::count_if(values.begin(), values.end(), predicate));
+  };
+  ASSERT_EQ(sliced.Count(Comparison::kLess, 500), count([](uint32_t v) { return v < 500; }));
+  ASSERT_EQ(sliced.Count(Comparison::kLessOrEqual, 500), count([](uint32_t v) { return v <= 500; }));
+  ASSERT_EQ(sliced.Count(Comparison::kEqual, values[17]), count([&](uint32_t v) { return v == values[17]; }));
+  ASSERT_EQ(sliced.Count(Comparison::kNotEqual, values[17]), count([&](uint32_t v) { return v != values[17]; }));
+  ASSERT_EQ(sliced.Count(Comparison::kGreater, 900), count([](uint32_t v) { return v > 900; }));
+  ASSERT_EQ(sliced.Count(Comparison::kGreaterOrEqual, 0), 150u);
+  ASSERT_EQ(sliced.Count(Comparison::kLess, 1u << 20), 150u);
+  ASSERT_EQ(sliced.CountInRange(100, 300), count([](uint32_t v) { return v >= 100 && v <= 300; }));
+  const auto mask = sliced.Compare(Comparison::kEqual, values[100]);
+  ASSERT_TRUE((mask[1] >> 36) & 1);
+}
+
+TEST(BitSlicedArrayTest, ArithmeticTest) {
+  std::vector<uint32_t> lhs_values(100), rhs_values(100);
+  for (size_t i = 0; i != 100; ++i) {
+    lhs_values[i] = static_cast<uint32_t>(i * 1311 % 131072);
+    rhs_values[i] = static_cast<uint32_t>(i * 7777 % 131072);
+  }
+  BitSlicedArray<17> lhs(100), rhs(100);
+  lhs.Pack(lhs_values.data(), 0, 100);
+  rhs.Pack(rhs_values.data(), 0, 100);
+  lhs += rhs;
+  lhs -= 3u;
+  for (size_t i = 0; i != 100; ++i) {
+    ASSERT_EQ(lhs[i].ToUInt32(), (lhs_values[i] + rhs_values[i] - 3) & 131071u);
+  }
+  lhs -= rhs;
+  lhs += 3u;
+  std::vector<uint32_t> decoded(100);
+  lhs.Unpack(0, 100, decoded.data());
+  ASSERT_EQ(decoded, lhs_values);
+  ASSERT_THROW(lhs += BitSlicedArray<17>(99), std::logic_error);
+}
+
+TEST(BitSlicedArrayTest, ParallelTest) {
+  ThreadPool pool(4);
+  const size_t length = 300001;  // not a multiple of the slice length
+  BitSlicedArray<17> sliced(length);
+  ArrayWithVectorsView<1, BitSlicedArray<17>> view(sliced, 0, length);
+  for (size_t i = 0; i != length; ++i) {
+    sliced[i] = static_cast<uint32_t>(i * 2654435761u) & 0x1FFFFu;
+  }
+  auto [sum, sum_array] = (view + view).Evaluate(pool);
+  ArrayWithVectorsView<1, BitSlicedArray<17>> tail(sliced, 5, length - 5);  // pieces do not start on a slice
+  (tail * 3u).EvaluateInto(tail, pool);
+  for (size_t i = 0; i != length; ++i) {
+    const auto value = static_cast<uint32_t>(i * 2654435761u) & 0x1FFFFu;
+    ASSERT_EQ(sum[i].ToUInt32(), (2 * value) & 0x1FFFFu);
+    ASSERT_EQ(sliced[i].ToUInt32(), (i < 5) ? value : (3 * value) & 0x1FFFFu);
+  }
+  parallel::Fill(tail, 9u, pool);
+  ASSERT_EQ(BitSlicedArray<17>::Count(sliced.Compare(Comparison::kEqual, 9u)), length - 5);
+  delete sum_array;
+}
@@ -1,10 +1,24 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <cstddef>
 #include <cstdint>
 #include <stdexcept>
+#include <system_error>
+#include <vector>
 #include <concepts>
 #include <climits>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "array_iterator.h"
+#include "atomic_view.h"
+#include "buffer_pool.h"
+#include "packing.h"
 #include "uint17_view.h"
 #include "utils.h"
 
@@ -12,40 +26,112 @@ namespace uint17 {
 
 template <typename T>
 concept NumberView = std::constructible_from<T, uint8_t*, size_t> && requires(T n, uint32_t v) {
-  std::same_as<decltype(T::kBitLength), const  size_t>;
+  requires std::same_as<decltype(T::kBitLength), const  size_t>;
   n = v;
 };
 
+namespace detail {
+
+// element and bulk access over the packed bytes of a container, shared by Array and MappedArray
+template <NumberView View>
+struct PackedAccess {
+  static size_t BytesFor(size_t length) {
+    const auto length_in_bits = length * View::kBitLength;
+
+    return (length_in_bits % CHAR_BIT == 0) ? length_in_bits / CHAR_BIT : length_in_bits / CHAR_BIT + 1;
+  }
+
+  static View Element(uint8_t* data, size_t index) {
+    const auto start_of_number = index * View::kBitLength;
+
+    return View(data + start_of_number / CHAR_BIT, start_of_number % CHAR_BIT);
+  }
+  static void CheckIndex(size_t index, size_t length, const char* where) {
+    if (index >= length) {
+      throw std::out_of_range(where);
+    }
+  }
+  static void CheckRange(size_t begin, size_t count, size_t length, const char* where) {
+    if (begin > length || count > length - begin) {
+      throw std::out_of_range(where);
+    }
+  }
+
+  // decodes numbers [begin, begin + count) into out, whole groups at once for UIntNView (see packing.h)
+  static void Unpack(uint8_t* data, size_t begin, size_t count, uint32_t* out) {
+    if constexpr (PackedNumberView<View>) {
+      packing::Unpack<View::kBitLength>(data, begin, count, out);
+    } else {
+      for (size_t i = 0; i != count; ++i) {
+        out[i] = Element(data, begin + i).ToUInt32();
+      }
+    }
+  }
+  static void Pack(uint8_t* data, const uint32_t* in, size_t begin, size_t count) {
+    if constexpr (PackedNumberView<View>) {
+      packing::Pack<View::kBitLength>(data, in, begin, count);
+    } else {
+      for (size_t i = 0; i != count; ++i) {
+        Element(data, begin + i) = in[i];
+      }
+    }
+  }
+};
+
+}  // namespace detail
+
+/*
+  kUninitialized leaves the numbers as garbage for arrays that are written completely anyway.
+  kLazyZero maps anonymous memory instead of allocating it: the numbers read as zeros and a page of the buffer
+  takes physical memory only once it is written, so huge mostly-zero volumes cost what is actually touched
+  (see Array::Compact)
+ */
+enum class Initialization { kUninitialized, kZero, kLazyZero };
+// kCopyOnWrite: copies share the buffer until one of them is accessed for writing, see Array::SetCopyPolicy
+enum class CopyPolicy { kEager, kCopyOnWrite };
+
+/*
+  Packed numbers in a cache-line aligned buffer followed by packing::kTailSlack spare bytes,
+  so reading any number is one unaligned word load (see packing::ReadBits)
+ */
 template <NumberView View = UInt17View>
 class Array {
+  using Access = detail::PackedAccess<View>;
+
  public:
-  explicit Array(size_t length): length_(length) {
-    const auto length_in_bits = length * View::kBitLength;
-    length_in_bytes_ = (length_in_bits % CHAR_BIT == 0) ? length_in_bits / CHAR_BIT : length_in_bits / CHAR_BIT + 1;
-    data_ = new uint8_t[length_in_bytes_];
-  }
-  Array(std::initializer_list<uint32_t> elems): length_(elems.size()) {
-    const auto length_in_bits = length_ * View::kBitLength;
-    length_in_bytes_ = (length_in_bits % CHAR_BIT == 0) ? length_in_bits / CHAR_BIT : length_in_bits / CHAR_BIT + 1;
-    data_ = new uint8_t[length_in_bytes_];
+  using iterator = ArrayIterator<View, false>;
+  using const_iterator = ArrayIterator<View, true>;
 
+  explicit Array(size_t length, Initialization initialization = Initialization::kUninitialized)
+    : Array(length, nullptr, initialization) {}
+  // buffer is taken from pool and returned to it on destruction, pool must outlive the array, kLazyZero is not supported
+  Array(size_t length, BufferPool& pool, Initialization initialization = Initialization::kUninitialized)
+    : Array(length, &pool, initialization) {}
+  Array(std::initializer_list<uint32_t> elems): Array(elems.size(), nullptr, Initialization::kUninitialized) {
     size_t i = 0;
     for (uint32_t elem : elems) {
-      const auto start_of_number = i * View::kBitLength;
-      View(data_ + start_of_number / CHAR_BIT, start_of_number % CHAR_BIT) = elem;
-      ++i;
+      Access::Element(data_, i++) = elem;
     }
   }
-  Array(Array&& other): length_in_bytes_(other.length_in_bytes_), length_(other.length_) {
+  Array(Array&& other)
+    : length_in_bytes_(other.length_in_bytes_), length_(other.length_), pool_(other.pool_), shares_(other.shares_),
+      is_mapped_(other.is_mapped_), is_sharable_(other.is_sharable_.load(std::memory_order_relaxed)) {
     data_ = other.data_;
     other.data_ = nullptr;
     other.length_ = 0;
     other.length_in_bytes_ = 0;
+    other.shares_ = nullptr;
   }
-  Array(const Array& other): Array(other.length_) {
-    // std::memcpy(data_, other.data_, length_);  Not allowed to use memcpy by TA. But why???
-    for (size_t i = 0; i != length_in_bytes_; ++i) {
-      data_[i] = other.data_[i];
+  Array(const Array& other)
+    : data_(other.data_), length_in_bytes_(other.length_in_bytes_), length_(other.length_),
+      pool_(other.pool_), shares_(other.shares_), is_mapped_(other.is_mapped_) {
+    if (shares_ != nullptr && other.is_sharable_.load(std::memory_order_relaxed)) {  // copy-on-write, the copy has the same policy as other
+      shares_->fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    data_ = CopyBuffer();
+    if (shares_ != nullptr) {  // writable views of other may still exist, they must not write into the copy
+      shares_ = new std::atomic<size_t>(1);
     }
   }
   Array& operator=(const Array& other) {
@@ -62,41 +148,406 @@ class Array {
     utils::Swap(data_, other.data_);
     utils::Swap(length_, other.length_);
     utils::Swap(length_in_bytes_, other.length_in_bytes_);
+    utils::Swap(pool_, other.pool_);
+    utils::Swap(shares_, other.shares_);
+    utils::Swap(is_mapped_, other.is_mapped_);
+    is_sharable_.store(other.is_sharable_.exchange(is_sharable_.load(std::memory_order_relaxed), std::memory_order_relaxed),
+                       std::memory_order_relaxed);
 
     return *this;
   }
   ~Array() {
-    delete[] data_;
+    ReleaseBuffer();
+  }
+
+  /*
+    With kCopyOnWrite copies made from this array share its buffer through a reference count,
+    which makes copying a volume that is then only read free. The first non-const access of
+    a shared array (operator[], At, Pack, begin(), Data(), ...) gives it a private copy of the buffer,
+    so read copies through const references or views over a const container (ArrayView<3, const Array<>>).
+    Once the array hands out something that can write later (operator[], At, AtomicAt, begin(), Data()),
+    its copies are eager again, since writes through it would reach every copy. Calling SetCopyPolicy(kCopyOnWrite)
+    again states that no such view, iterator or pointer is used anymore and lets copies share the buffer.
+    Switching back to kEager gives the array a private buffer
+   */
+  void SetCopyPolicy(CopyPolicy policy) {
+    if (policy == CopyPolicy::kCopyOnWrite) {
+      if (shares_ == nullptr) {
+        shares_ = new std::atomic<size_t>(1);
+      }
+      is_sharable_.store(true, std::memory_order_relaxed);
+    } else if (policy == CopyPolicy::kEager && shares_ != nullptr) {
+      Detach();
+      delete shares_;
+      shares_ = nullptr;
+    }
+  }
+  [[nodiscard]] CopyPolicy GetCopyPolicy() const {
+    return (shares_ == nullptr) ? CopyPolicy::kEager : CopyPolicy::kCopyOnWrite;
+  }
+  /*
+    Gives a shared buffer its private copy on the calling thread. Detaching is not thread safe, so parallel stores
+    (EvaluateInto with a pool, parallel::Fill, parallel::Copy) call it before the work fans out,
+    and it has to be called before threads write through AtomicAt or operator[] of Array<AtomicUIntNView<Bits>>
+   */
+  void PrepareForWrite() {
+    DetachIfShared();
+  }
+  // true while the buffer is shared with a copy-on-write copy
+  [[nodiscard]] bool IsShared() const {
+    return shares_ != nullptr && shares_->load(std::memory_order_acquire) != 1;
   }
+
   [[nodiscard]] size_t size() const { return length_; }
-  View operator[](size_t index) {
-    const auto start_of_number = index * View::kBitLength;
+  [[nodiscard]] size_t SizeInBytes() const { return length_in_bytes_; }
+  [[nodiscard]] bool IsLazyZero() const { return is_mapped_; }
 
-    return View(data_ + start_of_number / CHAR_BIT, start_of_number % CHAR_BIT);
+  /*
+    true if numbers [begin, begin + count) are all zero, whole groups of 8 numbers are checked as bytes.
+    Pages of a kLazyZero array that were never written are skipped without reading them
+   */
+  [[nodiscard]] bool IsZeroRegion(size_t begin, size_t count) const {
+    if (begin > length_ || count > length_ - begin) {
+      throw std::out_of_range("Array::IsZeroRegion");
+    }
+    const auto end = begin + count;
+    const auto first_group = (begin + packing::kGroupLength - 1) / packing::kGroupLength;
+    const auto last_group = end / packing::kGroupLength;
+    if (first_group >= last_group) {  // no whole group inside
+      return IsZeroNumbers(begin, end);
+    }
+
+    return IsZeroNumbers(begin, first_group * packing::kGroupLength) &&
+           IsZeroNumbers(last_group * packing::kGroupLength, end) &&
+           IsZeroBuffer(first_group * View::kBitLength, last_group * View::kBitLength);
   }
-  const View operator[](size_t index) const {
-    const auto start_of_number = index * View::kBitLength;
+  /*
+    Physical memory taken by the buffer: the resident pages of a kLazyZero array (pages that were only read
+    map the shared zero page, but are counted too), the whole buffer for other arrays
+   */
+  [[nodiscard]] size_t ResidentBytes() const {
+    if (!is_mapped_ || data_ == nullptr) {
+      return (data_ == nullptr) ? 0 : AllocationSize(length_in_bytes_);
+    }
+    const auto page_size = PageSize();
+    std::vector<unsigned char> resident(MappingSize(length_in_bytes_) / page_size);
+    if (::mincore(data_, MappingSize(length_in_bytes_), resident.data()) == -1) {
+      throw std::system_error(errno, std::generic_category(), "Array::ResidentBytes");
+    }
+    size_t result = 0;
+    for (const auto page : resident) {
+      result += (page & 1) ? page_size : 0;
+    }
 
-    return View(data_ + start_of_number / CHAR_BIT, start_of_number % CHAR_BIT);
+    return result;
   }
-  View At(size_t index) {
-    if (index >= length_) {
-      throw std::out_of_range("Array::at");
+  /*
+    Returns the pages of a kLazyZero array that hold only zeros to the system, they read as zeros afterwards
+    and take memory again when written. Returns the number of pages released (including pages that were only read,
+    which map the shared zero page), always 0 for other arrays.
+    Views and iterators stay valid. Must not run concurrently with writes to the array
+   */
+  size_t Compact() {
+    if (!is_mapped_ || data_ == nullptr) {
+      return 0;
     }
+    const auto page_size = PageSize();
+    size_t released = 0;
+    ForEachWrittenPage(0, MappingSize(length_in_bytes_) / page_size, [&](size_t page, bool is_present) {
+      auto* bytes = data_ + page * page_size;
+      if (!is_present || !IsZeroBytes(bytes, page_size)) {  // swapped out pages are left alone
+        return true;
+      }
+      if (::madvise(bytes, page_size, MADV_DONTNEED) == -1) {
+        throw std::system_error(errno, std::generic_category(), "Array::Compact");
+      }
+      ++released;
+
+      return true;
+    });
+
+    return released;
+  }
+
+  // packed bit stream of all numbers, SizeInBytes() bytes
+  [[nodiscard]] uint8_t* Data() {
+    DetachForWriting();
+
+    return data_;
+  }
+  [[nodiscard]] const uint8_t* Data() const { return data_; }
+  iterator begin() {
+    DetachForWriting();
+
+    return {data_, 0};
+  }
+  iterator end() {
+    DetachForWriting();
+
+    return {data_, length_};
+  }
+  const_iterator begin() const { return {data_, 0}; }
+  const_iterator end() const { return {data_, length_}; }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  View operator[](size_t index) {
+    DetachForWriting();
+
+    return Access::Element(data_, index);
+  }
+  const View operator[](size_t index) const { return Access::Element(data_, index); }
+  View At(size_t index) {
+    Access::CheckIndex(index, length_, "Array::at");
 
     return this->operator[](index);
   }
   const View At(size_t index) const {
-    if (index >= length_) {
-      throw std::out_of_range("Array::at");
-    }
+    Access::CheckIndex(index, length_, "Array::at");
 
     return this->operator[](index);
   }
+  // atomic access to a number while other threads access the array, see AtomicUIntNView. The buffer must not be shared
+  AtomicUIntNView<View::kBitLength> AtomicAt(size_t index) requires PackedNumberView<View> {
+    Access::CheckIndex(index, length_, "Array::AtomicAt");
+    if (IsShared()) {  // threads calling AtomicAt at once would each detach the buffer
+      throw std::logic_error("Array::AtomicAt, the buffer is shared, call PrepareForWrite first");
+    }
+    DetachForWriting();
+    const auto start_of_number = index * View::kBitLength;
+
+    return AtomicUIntNView<View::kBitLength>(data_ + start_of_number / CHAR_BIT, start_of_number % CHAR_BIT);
+  }
+  /*
+    Bulk access: decodes numbers [begin, begin + count) into out / encodes count numbers from in starting at begin.
+    For UIntNView whole groups of 8 numbers (kBitLength bytes) are processed at once, see packing.h
+   */
+  void Unpack(size_t begin, size_t count, uint32_t* out) const {
+    Access::CheckRange(begin, count, length_, "Array::Unpack");
+    Access::Unpack(data_, begin, count, out);
+  }
+  void Pack(const uint32_t* in, size_t begin, size_t count) {
+    Access::CheckRange(begin, count, length_, "Array::Pack");
+    DetachIfShared();
+    Access::Pack(data_, in, begin, count);
+  }
  private:
+  Array(size_t length, BufferPool* pool, Initialization initialization)
+    : length_(length), pool_(pool), is_mapped_(initialization == Initialization::kLazyZero) {
+    length_in_bytes_ = Access::BytesFor(length);
+    if (is_mapped_) {
+      if (pool_ != nullptr) {
+        throw std::invalid_argument("Array::Array, kLazyZero arrays do not use a pool");
+      }
+      data_ = MapZeroPages(length_in_bytes_);  // zeros including the slack
+      return;
+    }
+    const auto allocation_size = AllocationSize(length_in_bytes_);
+    data_ = (pool_ != nullptr) ? pool_->Acquire(allocation_size) : utils::AllocateAligned(allocation_size);
+    // the slack is always zeroed, so word loads past the last number never see uninitialized memory
+    const auto zero_from = (initialization == Initialization::kZero) ? 0 : length_in_bytes_;
+    std::memset(data_ + zero_from, 0, allocation_size - zero_from);
+  }
+
+  void DetachIfShared() {
+    if (shares_ != nullptr && shares_->load(std::memory_order_acquire) != 1) {
+      Detach();
+    }
+  }
+  // before handing out a view, iterator or pointer that may write after the array is copied
+  void DetachForWriting() {
+    if (shares_ == nullptr) {  // eager copies never share, nothing to record
+      return;
+    }
+    DetachIfShared();
+    // AtomicAt may be called from several threads, and operator[] in hot loops should not keep storing
+    if (is_sharable_.load(std::memory_order_relaxed)) {
+      is_sharable_.store(false, std::memory_order_relaxed);
+    }
+  }
+  // gives the array a private copy of a shared buffer with a reference count of its own
+  void Detach() {
+    if (shares_->load(std::memory_order_acquire) == 1) {
+      return;
+    }
+    auto* copy = CopyBuffer();
+    ReleaseBuffer();
+    data_ = copy;
+    shares_ = new std::atomic<size_t>(1);
+  }
+  // new buffer with the contents of data_ including the zeroed slack, copied in bulk
+  uint8_t* CopyBuffer() const {
+    if (is_mapped_) {  // only the written pages holding nonzero bytes are copied, the rest of the copy stays unallocated
+      auto* copy = MapZeroPages(length_in_bytes_);
+      if (data_ == nullptr) {
+        return copy;
+      }
+      const auto page_size = PageSize();
+      ForEachWrittenPage(0, MappingSize(length_in_bytes_) / page_size, [&](size_t page, bool) {
+        if (!IsZeroBytes(data_ + page * page_size, page_size)) {
+          std::memcpy(copy + page * page_size, data_ + page * page_size, page_size);
+        }
+
+        return true;
+      });
+
+      return copy;
+    }
+    const auto allocation_size = AllocationSize(length_in_bytes_);
+    auto* copy = (pool_ != nullptr) ? pool_->Acquire(allocation_size) : utils::AllocateAligned(allocation_size);
+    if (data_ != nullptr) {
+      std::memcpy(copy, data_, allocation_size);
+    } else {  // copy of a moved-from array
+      std::memset(copy, 0, allocation_size);
+    }
+
+    return copy;
+  }
+  // the last of the arrays sharing data_ frees it
+  void ReleaseBuffer() {
+    if (shares_ != nullptr) {
+      if (shares_->fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+      }
+      delete shares_;
+    }
+    if (is_mapped_) {
+      if (data_ != nullptr) {
+        ::munmap(data_, MappingSize(length_in_bytes_));
+      }
+    } else if (pool_ != nullptr) {
+      pool_->Release(data_, AllocationSize(length_in_bytes_));
+    } else if (data_ != nullptr) {
+      utils::FreeAligned(data_);
+    }
+  }
+
+  // whole cache lines including the tail slack, which also keeps the aligned words of AtomicUIntNView inside
+  static size_t AllocationSize(size_t length_in_bytes) {
+    const auto size = length_in_bytes + packing::kTailSlack;
+
+    return (size + utils::kCacheLineSize - 1) / utils::kCacheLineSize * utils::kCacheLineSize;
+  }
+  // whole pages for kLazyZero, so Compact never releases memory outside the buffer
+  static size_t MappingSize(size_t length_in_bytes) {
+    const auto page_size = PageSize();
+
+    return (AllocationSize(length_in_bytes) + page_size - 1) / page_size * page_size;
+  }
+  static size_t PageSize() {
+    static const auto page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+
+    return page_size;
+  }
+  static uint8_t* MapZeroPages(size_t length_in_bytes) {
+    auto* mapping = ::mmap(nullptr, MappingSize(length_in_bytes), PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapping == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+
+    return static_cast<uint8_t*>(mapping);
+  }
+  // decodes numbers [begin, end) a group at a time
+  bool IsZeroNumbers(size_t begin, size_t end) const {
+    if (IsZeroBuffer(begin * View::kBitLength / CHAR_BIT, (end * View::kBitLength + CHAR_BIT - 1) / CHAR_BIT)) {
+      return true;  // all bits of the numbers are zero, no need to decode (or to read a page never written)
+    }
+    uint32_t numbers[packing::kGroupLength];
+    for (; begin < end; begin += packing::kGroupLength) {
+      const auto count = std::min<size_t>(packing::kGroupLength, end - begin);
+      Unpack(begin, count, numbers);
+      for (size_t i = 0; i != count; ++i) {
+        if (numbers[i] != 0) {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+  // bytes [begin, end) of data_ are zero, for kLazyZero only the written pages are read
+  bool IsZeroBuffer(size_t begin, size_t end) const {
+    if (!is_mapped_) {
+      return IsZeroBytes(data_ + begin, end - begin);
+    }
+    const auto page_size = PageSize();
+    bool result = true;
+    ForEachWrittenPage(begin / page_size, (end + page_size - 1) / page_size, [&](size_t page, bool) {
+      const auto from = std::max(begin, page * page_size);
+      const auto to = std::min(end, (page + 1) * page_size);
+      result = IsZeroBytes(data_ + from, to - from);
+
+      return result;
+    });
+
+    return result;
+  }
+  /*
+    Calls function(page, is_present) for the pages [first, last) of a kLazyZero buffer that may hold nonzero bytes:
+    present or swapped out according to /proc/self/pagemap (mincore cannot tell swapped out pages from
+    pages never written, which read as zeros). function returns false to stop.
+    Without pagemap every page is passed as present
+   */
+  template <typename Function>
+  void ForEachWrittenPage(size_t first, size_t last, Function&& function) const {
+    constexpr uint64_t kPresent = uint64_t{1} << 63;
+    constexpr uint64_t kSwapped = uint64_t{1} << 62;
+    constexpr size_t kBatch = 512;
+    struct Pagemap {
+      int descriptor;
+      ~Pagemap() {
+        if (descriptor != -1) {
+          ::close(descriptor);
+        }
+      }
+    } pagemap{::open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC)};
+    const auto first_page = reinterpret_cast<uintptr_t>(data_) / PageSize();
+    uint64_t entries[kBatch];
+    for (size_t page = first; page < last;) {
+      const auto count = std::min(kBatch, last - page);
+      const auto bytes = static_cast<ssize_t>(count * sizeof(uint64_t));
+      if (pagemap.descriptor == -1 ||
+          ::pread(pagemap.descriptor, entries, count * sizeof(uint64_t),
+                  static_cast<off_t>((first_page + page) * sizeof(uint64_t))) != bytes) {
+        std::fill(entries, entries + count, kPresent);  // state unknown, every page may hold numbers
+      }
+      for (size_t i = 0; i != count; ++i, ++page) {
+        if ((entries[i] & (kPresent | kSwapped)) != 0 && !function(page, (entries[i] & kPresent) != 0)) {
+          return;
+        }
+      }
+    }
+  }
+  // word-wide OR over the bytes, a cache line per test
+  static bool IsZeroBytes(const uint8_t* bytes, size_t size) {
+    size_t i = 0;
+    for (; i + utils::kCacheLineSize <= size; i += utils::kCacheLineSize) {
+      uint64_t any = 0;
+      for (size_t w = 0; w != utils::kCacheLineSize / sizeof(uint64_t); ++w) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i + w * sizeof(uint64_t), sizeof(word));
+        any |= word;
+      }
+      if (any != 0) {
+        return false;
+      }
+    }
+    for (; i != size; ++i) {
+      if (bytes[i] != 0) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
   uint8_t* data_;
   size_t length_in_bytes_;
   size_t length_;
+  BufferPool* pool_ = nullptr;  // owner of data_, nullptr if it came from utils::AllocateAligned
+  std::atomic<size_t>* shares_ = nullptr;  // arrays sharing data_, nullptr unless the policy is kCopyOnWrite
+  bool is_mapped_ = false;  // data_ is an anonymous mapping of MappingSize bytes (kLazyZero)
+  std::atomic<bool> is_sharable_ = true;  // no writable view of data_ was handed out since SetCopyPolicy(kCopyOnWrite)
 };
 
 }  // namespace uint17
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include "array.h"
+#include "array_view.h"
+#include "array_with_vectors_view.h"
+#include "buffer_pool.h"
+
+namespace uint17 {
+
+/*
+  Owning counterpart of ViewWithContainer / VectorsViewWithContainer: keeps the container alive
+  and deletes it with the handle, moves are cheap (the container stays where it is, so views stay valid).
+  GetView() is an ArrayWithVectorsView whenever the container supports arithmetic.
+
+    ArrayHandle<3> volume = ArrayHandle<3>::Make(pool, 512u, 512u, 512u);
+    ArrayHandle sum((a + b).Evaluate());  // adopts the container of Evaluate / MakeArray
+ */
+template <size_t Dimension, RandomAccessContainer Container = Array<UInt17View>>
+class ArrayHandle {
+ public:
+  using ViewType = std::conditional_t<RandomAccessContainerWithVectors<Container>,
+                                      ArrayWithVectorsView<Dimension, Container>, ArrayView<Dimension, Container>>;
+
+  ArrayHandle(std::unique_ptr<Container> container, size_t start, const size_t* dimensions)
+    : container_(std::move(container)), start_(start) {
+    for (size_t i = 0; i != Dimension; ++i) {
+      dimensions_[i] = dimensions[i];
+    }
+    static_cast<void>(ViewType(*container_, start_, dimensions_));  // same bounds check as the view
+  }
+  explicit ArrayHandle(const ViewWithContainer<Dimension, Container>& owned)
+    : ArrayHandle(std::unique_ptr<Container>(owned.container), owned.view) {}
+  explicit ArrayHandle(const VectorsViewWithContainer<Dimension, Container>& owned)
+    requires RandomAccessContainerWithVectors<Container>
+    : ArrayHandle(std::unique_ptr<Container>(owned.container), owned.view) {}
+
+  template <typename... Args> requires Dimensions<Dimension, Args...>
+  static ArrayHandle Make(Args... dimensions) {
+    const size_t sizes[] = {static_cast<size_t>(dimensions)...};
+
+    return ArrayHandle(std::make_unique<Container>((dimensions * ...)), 0, sizes);
+  }
+  // container buffer comes from pool and goes back to it when the handle dies
+  template <typename... Args> requires (Dimensions<Dimension, Args...> && std::constructible_from<Container, size_t, BufferPool&>)
+  static ArrayHandle Make(BufferPool& pool, Args... dimensions) {
+    const size_t sizes[] = {static_cast<size_t>(dimensions)...};
+
+    return ArrayHandle(std::make_unique<Container>((dimensions * ...), pool), 0, sizes);
+  }
+
+  [[nodiscard]] ViewType GetView() const { return ViewType(*container_, start_, dimensions_); }
+  [[nodiscard]] Container& GetContainer() const { return *container_; }
+  [[nodiscard]] size_t GetDimension(size_t index) const { return dimensions_[index]; }
+  [[nodiscard]] size_t GetLength() const {
+    size_t length = 1;
+    for (size_t i = 0; i != Dimension; ++i) {
+      length *= dimensions_[i];
+    }
+
+    return length;
+  }
+  // gives up ownership, the caller deletes the container as with MakeArray
+  Container* Release() { return container_.release(); }
+
+  decltype(auto) operator[](size_t index) const { return GetView()[index]; }
+  template <typename... Args> requires Dimensions<Dimension, Args...>
+  decltype(auto) operator()(Args... indices) const { return GetView()(indices...); }
+
+ private:
+  template <typename View>
+  ArrayHandle(std::unique_ptr<Container> container, const View& view)
+    : container_(std::move(container)), start_(view.GetStart()) {
+    for (size_t i = 0; i != Dimension; ++i) {
+      dimensions_[i] = view.GetDimension(i);
+    }
+  }
+
+  std::unique_ptr<Container> container_;
+  size_t start_;
+  size_t dimensions_[Dimension];
+};
+
+template <size_t Dimension, RandomAccessContainer Container>
+ArrayHandle(const ViewWithContainer<Dimension, Container>&) -> ArrayHandle<Dimension, Container>;
+template <size_t Dimension, RandomAccessContainerWithVectors Container>
+ArrayHandle(const VectorsViewWithContainer<Dimension, Container>&) -> ArrayHandle<Dimension, Container>;
+
+// evaluates expression into a new array whose buffer comes from pool
+template <size_t Dimension, RandomAccessContainerWithVectors Container, typename Node>
+  requires std::constructible_from<Container, size_t, BufferPool&>
+ArrayHandle<Dimension, Container> Evaluate(const VectorsExpression<Dimension, Container, Node>& expression,
+                                           BufferPool& pool) {
+  size_t dimensions[Dimension];
+  for (size_t i = 0; i != Dimension; ++i) {
+    dimensions[i] = expression.GetDimension(i);
+  }
+  ArrayHandle<Dimension, Container> result(std::make_unique<Container>(expression.GetLength(), pool), 0, dimensions);
+  expression.EvaluateInto(result.GetView());
+
+  return result;
+}
+
+}  // namespace uint17
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+#include <compare>
+#include <iterator>
+#include <type_traits>
+
+namespace uint17 {
+
+/*
+  Random access iterator over packed numbers, like std::vector<bool>::iterator it dereferences to a View proxy.
+  It keeps the byte pointer and the bit offset inside that byte, so ++ is an add and a carry
+  instead of index * kBitLength / CHAR_BIT
+ */
+template <typename View, bool IsConst>
+class ArrayIterator {
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using iterator_concept = std::random_access_iterator_tag;
+  using value_type = uint32_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = std::conditional_t<IsConst, const View, View>;
+  using pointer = void;
+
+  ArrayIterator() = default;
+  ArrayIterator(uint8_t* data, size_t index)
+    : byte_(data + index * View::kBitLength / CHAR_BIT), bit_(index * View::kBitLength % CHAR_BIT) {}
+  template <bool OtherIsConst> requires (IsConst && !OtherIsConst)
+  ArrayIterator(const ArrayIterator<View, OtherIsConst>& other): byte_(other.byte_), bit_(other.bit_) {}
+
+  reference operator*() const { return View(byte_, static_cast<uint8_t>(bit_)); }
+  reference operator[](difference_type n) const { return *(*this + n); }
+
+  ArrayIterator& operator++() {
+    bit_ += View::kBitLength;
+    byte_ += bit_ / CHAR_BIT;
+    bit_ %= CHAR_BIT;
+
+    return *this;
+  }
+  ArrayIterator operator++(int) {
+    auto copy = *this;
+    ++*this;
+
+    return copy;
+  }
+  ArrayIterator& operator--() { return *this -= 1; }
+  ArrayIterator operator--(int) {
+    auto copy = *this;
+    --*this;
+
+    return copy;
+  }
+  ArrayIterator& operator+=(difference_type n) {
+    auto bits = static_cast<difference_type>(bit_) + n * static_cast<difference_type>(View::kBitLength);
+    auto bytes = bits / CHAR_BIT;
+    bits %= CHAR_BIT;
+    if (bits < 0) {  // floor division for negative steps
+      bits += CHAR_BIT;
+      --bytes;
+    }
+    byte_ += bytes;
+    bit_ = static_cast<size_t>(bits);
+
+    return *this;
+  }
+  ArrayIterator& operator-=(difference_type n) { return *this += -n; }
+
+  friend ArrayIterator operator+(ArrayIterator it, difference_type n) { return it += n; }
+  friend ArrayIterator operator+(difference_type n, ArrayIterator it) { return it += n; }
+  friend ArrayIterator operator-(ArrayIterator it, difference_type n) { return it -= n; }
+  friend difference_type operator-(const ArrayIterator& lhs, const ArrayIterator& rhs) {
+    const auto bits = (lhs.byte_ - rhs.byte_) * CHAR_BIT
+        + static_cast<difference_type>(lhs.bit_) - static_cast<difference_type>(rhs.bit_);
+
+    return bits / static_cast<difference_type>(View::kBitLength);
+  }
+
+  friend bool operator==(const ArrayIterator& lhs, const ArrayIterator& rhs) {
+    return lhs.byte_ == rhs.byte_ && lhs.bit_ == rhs.bit_;
+  }
+  friend auto operator<=>(const ArrayIterator& lhs, const ArrayIterator& rhs) {
+    return (lhs.byte_ != rhs.byte_) ? lhs.byte_ <=> rhs.byte_ : lhs.bit_ <=> rhs.bit_;
+  }
+
+ private:
+  friend class ArrayIterator<View, true>;
+
+  uint8_t* byte_ = nullptr;  // first byte of current number
+  size_t bit_ = 0;  // offset of current number in that byte
+};
+
+/*
+  Iterator for containers that have only operator[], used by ArrayView for containers without begin()
+ */
+template <typename Container>
+class IndexIterator {
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using difference_type = std::ptrdiff_t;
+  using reference = decltype(std::declval<Container&>()[size_t{}]);
+  using value_type = std::remove_cvref_t<reference>;
+  using pointer = void;
+
+  IndexIterator() = default;
+  IndexIterator(Container& container, size_t index): container_(&container), index_(index) {}
+
+  reference operator*() const { return (*container_)[index_]; }
+  reference operator[](difference_type n) const { return (*container_)[index_ + n]; }
+
+  IndexIterator& operator++() {
+    ++index_;
+
+    return *this;
+  }
+  IndexIterator operator++(int) {
+    auto copy = *this;
+    ++index_;
+
+    return copy;
+  }
+  IndexIterator& operator--() {
+    --index_;
+
+    return *this;
+  }
+  IndexIterator operator--(int) {
+    auto copy = *this;
+    --index_;
+
+    return copy;
+  }
+  IndexIterator& operator+=(difference_type n) {
+    index_ += n;
+
+    return *this;
+  }
+  IndexIterator& operator-=(difference_type n) {
+    index_ -= n;
+
+    return *this;
+  }
+
+  friend IndexIterator operator+(IndexIterator it, difference_type n) { return it += n; }
+  friend IndexIterator operator+(difference_type n, IndexIterator it) { return it += n; }
+  friend IndexIterator operator-(IndexIterator it, difference_type n) { return it -= n; }
+  friend difference_type operator-(const IndexIterator& lhs, const IndexIterator& rhs) {
+    return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+  }
+
+  friend bool operator==(const IndexIterator& lhs, const IndexIterator& rhs) { return lhs.index_ == rhs.index_; }
+  friend auto operator<=>(const IndexIterator& lhs, const IndexIterator& rhs) { return lhs.index_ <=> rhs.index_; }
+
+ private:
+  Container* container_ = nullptr;
+  size_t index_ = 0;
+};
+
+}  // namespace uint17
@@ -4,7 +4,10 @@
 #include <cstdint>
 #include <concepts>
 #include <exception>
+#include <type_traits>
 #include "array.h"
+#include "array_iterator.h"
+#include "packing.h"
 #include "uint17_view.h"
 #include "utils.h"
 
@@ -14,16 +17,67 @@ template <typename T>
 concept Size = std::convertible_to<T, size_t>;
 template <size_t Dimension, typename... Args>
 concept Dimensions = ((Size<Args> && ...) && sizeof...(Args) == Dimension);
+/*
+  Views over a const container (ArrayView<3, const Array<>>) are read-only: they never call the non-const accessors,
+  so reading a copy-on-write copy through them keeps its buffer shared
+ */
 template <typename T>
-concept RandomAccessContainer = std::constructible_from<T, size_t> && requires(T t, size_t index) {
+concept RandomAccessContainer = std::constructible_from<std::remove_const_t<T>, size_t> &&
+                                requires(std::remove_const_t<T> t, size_t index) {
   t[index];
   t[index] = t[index];
   { t.size() } -> std::same_as<size_t>;
 };
+template <typename T>
+concept BulkReadableContainer = requires(const T t, size_t index, uint32_t* out) {
+  t.Unpack(index, index, out);
+};
+template <typename T>
+concept BulkWritableContainer = requires(T t, size_t index, const uint32_t* in) {
+  t.Pack(in, index, index);
+};
+
+/*
+  Parallel stores (EvaluateInto with a pool, parallel::Fill, parallel::Copy) split the destination only where
+  index % kWriteAlignment<Container> == 0, so two threads never write the same byte of a packed container.
+  Containers whose writes reach further declare static constexpr size_t kWriteAlignment, 0 if only one thread may write
+ */
+template <typename T>
+constexpr size_t kWriteAlignment = packing::kGroupLength;
+template <typename T> requires requires { T::kWriteAlignment; }
+constexpr size_t kWriteAlignment<T> = T::kWriteAlignment;
+
+// called on the calling thread before parallel stores, containers sharing a buffer copy-on-write detach it here once
+template <typename T>
+void PrepareForWrite(T& container) {
+  if constexpr (requires { container.PrepareForWrite(); }) {
+    container.PrepareForWrite();
+  }
+}
+
+template <typename T>
+concept IterableContainer = requires(T t) {
+  t.begin() + size_t{};
+};
 
 template <size_t Dimension, RandomAccessContainer Container>
 struct ViewWithContainer;
 
+namespace detail {
+
+struct Unchecked {};  // sub-views of a checked view need no bounds check
+
+template <typename Container>
+auto IteratorAt(Container& container, size_t index) {
+  if constexpr (IterableContainer<Container>) {
+    return container.begin() + index;
+  } else {
+    return IndexIterator<Container>(container, index);
+  }
+}
+
+}  // namespace detail
+
 template <size_t Dimension, RandomAccessContainer Container = Array<UInt17View>>
 class ArrayView {
  public:
@@ -33,6 +87,7 @@ class ArrayView {
     if (end_ > container.size()) {
       throw std::out_of_range("ArrayView::ArrayView, view with given dimensions end after container end");
     }
+    ComputeStrides();
   }
   ArrayView(Container& container, size_t start, const size_t* dimensions): container_(container), start_(start) {
     size_t product = 1;
@@ -44,46 +99,58 @@ class ArrayView {
     if (end_ > container.size()) {
       throw std::out_of_range("ArrayView::ArrayView, view with given dimensions end after container end");
     }
+    ComputeStrides();
+  }
+  ArrayView(Container& container, size_t start, const size_t* dimensions, const size_t* strides, detail::Unchecked)
+    : container_(container), start_(start), end_(start + strides[0] * dimensions[0]) {
+    for (size_t i = 0; i != Dimension; ++i) {
+      dimensions_[i] = dimensions[i];
+      strides_[i] = strides[i];
+    }
   }
 
   ArrayView<Dimension - 1, Container> operator[](size_t index) {
     if (index >= dimensions_[0]) {
       throw std::out_of_range("ArrayView::operator[]");
     }
-    return ArrayView<Dimension - 1, Container>(container_, start_ + (end_ - start_) / dimensions_[0] * index, dimensions_ + 1);
+    return SubView(index);
   }
   const ArrayView<Dimension - 1, Container> operator[](size_t index) const {
     if (index >= dimensions_[0]) {
       throw std::out_of_range("ArrayView::operator[]");
     }
-    return ArrayView<Dimension - 1, Container>(container_, start_ + (end_ - start_) / dimensions_[0] * index, dimensions_ + 1);
+    return SubView(index);
+  }
+
+  // unchecked access to element (indices...), offset is a single dot product with the strides
+  template <typename... Args> requires Dimensions<Dimension, Args...>
+  decltype(auto) operator()(Args... indices) {
+    return container_[Offset(indices...)];
+  }
+  template <typename... Args> requires Dimensions<Dimension, Args...>
+  decltype(auto) operator()(Args... indices) const {
+    return static_cast<const Container&>(container_)[Offset(indices...)];
   }
 
   [[nodiscard]] size_t GetDimension(size_t index) const { return dimensions_[index]; }
+  [[nodiscard]] size_t GetStride(size_t index) const { return strides_[index]; }
+  [[nodiscard]] size_t GetLength() const { return end_ - start_; }
   [[nodiscard]] size_t GetStart() const { return start_; }
   [[nodiscard]] Container& GetContainer() const { return container_; }
 
-  template <typename... Args> requires Dimensions<Dimension, Args...>
-  decltype(auto) Get(Args... dimensions) {
-    size_t arguments[] = {(dimensions)...};
-    size_t real_index = start_;
-    for (size_t i = 0; i != Dimension - 1; ++i) {
-      real_index += arguments[i] * dimensions_[i];
-    }
-    real_index += arguments[Dimension - 1];
+  // iterate over all numbers of the view in row-major order
+  auto begin() { return detail::IteratorAt(container_, start_); }
+  auto end() { return detail::IteratorAt(container_, end_); }
+  auto begin() const { return detail::IteratorAt(static_cast<const Container&>(container_), start_); }
+  auto end() const { return detail::IteratorAt(static_cast<const Container&>(container_), end_); }
 
-    return container_[real_index];
+  template <typename... Args> requires Dimensions<Dimension, Args...>
+  decltype(auto) Get(Args... indices) {
+    return container_[Offset(indices...)];
   }
   template <typename...Args> requires Dimensions<Dimension, Args...>
-  decltype(auto) Get(Args... dimensions) const {
-    size_t arguments[] = {(dimensions)...};
-    size_t real_index = start_;
-    for (size_t i = 0; i != Dimension - 1; ++i) {
-      real_index += arguments[i] * dimensions_[i];
-    }
-    real_index += arguments[Dimension - 1];
-
-    return const_cast<const Container* const>(container_)[real_index];
+  decltype(auto) Get(Args... indices) const {
+    return static_cast<const Container&>(container_)[Offset(indices...)];
   }
 
   template <typename... Args> requires Dimensions<Dimension, Args...>
@@ -93,12 +160,42 @@ class ArrayView {
 
     return {view, container};
   }
+  // as MakeArray, but with a kLazyZero container: zeros that take memory only where they are written
+  template <typename... Args> requires Dimensions<Dimension, Args...> &&
+                                       std::constructible_from<Container, size_t, Initialization>
+  static ViewWithContainer<Dimension, Container> MakeLazyZeroArray(Args... args) {
+    auto container = new Container((args * ...), Initialization::kLazyZero);
+    auto view = ArrayView(*container, 0, args...);
+
+    return {view, container};
+  }
 
  protected:
+  void ComputeStrides() {
+    size_t stride = 1;
+    for (size_t i = Dimension; i != 0; --i) {
+      strides_[i - 1] = stride;
+      stride *= dimensions_[i - 1];
+    }
+  }
+  ArrayView<Dimension - 1, Container> SubView(size_t index) const {
+    return ArrayView<Dimension - 1, Container>(
+        container_, start_ + strides_[0] * index, dimensions_ + 1, strides_ + 1, detail::Unchecked{});
+  }
+  template <typename... Args>
+  size_t Offset(Args... indices) const {
+    size_t offset = start_;
+    size_t axis = 0;
+    ((offset += static_cast<size_t>(indices) * strides_[axis++]), ...);
+
+    return offset;
+  }
+
   Container& container_;
   size_t start_;
   size_t end_;
   size_t dimensions_[Dimension];
+  size_t strides_[Dimension];  // strides_[i] = dimensions_[i + 1] * ... * dimensions_[Dimension - 1]
 };
 
 template <RandomAccessContainer Container>
@@ -111,6 +208,8 @@ class ArrayView<1, Container> {
       throw std::out_of_range("ArrayView::ArrayView given offset + length > container length");
     }
   }
+  ArrayView(Container& container, size_t start, const size_t* length, const size_t*, detail::Unchecked)
+    : container_(container), start_(start), end_(start + *length) {}
   
   decltype(auto) operator[](size_t index) {
     if (start_ + index >= end_) {
@@ -124,15 +223,25 @@ class ArrayView<1, Container> {
       throw std::out_of_range("ArrayView::operator[]");
     }
 
-    return const_cast<const Container* const>(container_)[start_ + index];
+    return static_cast<const Container&>(container_)[start_ + index];
   }
 
   [[nodiscard]] size_t GetLength() const { return end_ - start_; }
+  [[nodiscard]] size_t GetDimension(size_t) const { return end_ - start_; }
+  [[nodiscard]] size_t GetStride(size_t) const { return 1; }
   [[nodiscard]] size_t GetStart() const { return start_; }
   [[nodiscard]] Container& GetContainer() const { return container_; }
+
+  auto begin() { return detail::IteratorAt(container_, start_); }
+  auto end() { return detail::IteratorAt(container_, end_); }
+  auto begin() const { return detail::IteratorAt(static_cast<const Container&>(container_), start_); }
+  auto end() const { return detail::IteratorAt(static_cast<const Container&>(container_), end_); }
+
+  decltype(auto) operator()(size_t index) { return container_[start_ + index]; }
+  decltype(auto) operator()(size_t index) const { return static_cast<const Container&>(container_)[start_ + index]; }
   decltype(auto) Get(size_t index) { return container_[start_ + index]; }
   decltype(auto) Get(size_t index) const {
-    return const_cast<const Container* const>(container_)[start_ + index];
+    return static_cast<const Container&>(container_)[start_ + index];
   }
 
   static ViewWithContainer<1, Container> MakeArray(size_t length) {
@@ -141,6 +250,13 @@ class ArrayView<1, Container> {
 
     return {view, container};
   }
+  static ViewWithContainer<1, Container> MakeLazyZeroArray(size_t length)
+    requires std::constructible_from<Container, size_t, Initialization> {
+    auto container = new Container(length, Initialization::kLazyZero);
+    auto view = ArrayView<1, Container>(*container, 0, length);
+
+    return {view, container};
+  }
 
  protected:
   Container& container_;
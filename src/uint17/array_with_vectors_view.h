@@ -1,11 +1,16 @@
 #pragma once
 
+#include <concepts>
+#include <type_traits>
 #include "array_view.h"
+#include "expression.h"
+#include "text_io.h"
 
 namespace uint17 {
 
 template<typename T>
-concept RandomAccessContainerWithVectors = RandomAccessContainer<T> && requires(T t, size_t index, uint32_t lambda) {
+concept RandomAccessContainerWithVectors = RandomAccessContainer<T> &&
+                                           requires(std::remove_const_t<T> t, size_t index, uint32_t lambda) {
   t[index] *= lambda;
   t[index] += t[index];
   t[index] -= t[index];
@@ -13,51 +18,21 @@ concept RandomAccessContainerWithVectors = RandomAccessContainer<T> && requires(
 
 template <size_t Dimension, RandomAccessContainerWithVectors Container>
 struct VectorsViewWithContainer;
+template <size_t Dimension, RandomAccessContainerWithVectors Container, typename Node>
+class VectorsExpression;
 
 template <size_t Dimension, RandomAccessContainerWithVectors Container = Array<UInt17View>>
 class ArrayWithVectorsView: public ArrayView<Dimension, Container> {
  public:
   using ArrayView<Dimension, Container>::ArrayView;
-  VectorsViewWithContainer<Dimension, Container> operator*(uint32_t lambda) {
-    auto container = new Container(this->container_.size() - this->start_);
-    for (size_t i = 0; i != this->end_ - this->start_; ++i) {
-      container->operator[](i) = this->container_[this->start_ + i];
-      container->operator[](i) *= lambda;
-    }
-    auto view = ArrayWithVectorsView(*container, 0, this->dimensions_);
 
-    return {view, container};
-  }
-  VectorsViewWithContainer<Dimension, Container> operator+(const ArrayWithVectorsView<Dimension, Container>& other) {
-    for (size_t i = 0; i != Dimension; ++i) {
-      if (this->dimensions_[i] != other.dimensions_[i]) {
-        throw std::logic_error("ArrayView::operator+ different dimensions used");
-      }
-    }
-    auto container = new Container(this->container_.size() - this->start_);
-    for (size_t i = 0; i != this->end_ - this->start_; ++i) {
-      container->operator[](i) = this->container_[this->start_ + i];
-      container->operator[](i) += other.container_[other.start_ + i];
-    }
-    auto view = ArrayWithVectorsView(*container, 0, this->dimensions_);
+  template <typename Node>
+  ArrayWithVectorsView& operator=(const VectorsExpression<Dimension, Container, Node>& expression) {
+    expression.EvaluateInto(*this);
 
-    return {view, container};
+    return *this;
   }
-  VectorsViewWithContainer<Dimension, Container> operator-(const ArrayWithVectorsView<Dimension, Container>& other) {
-    for (size_t i = 0; i != Dimension; ++i) {
-      if (this->dimensions_[i] != other.dimensions_[i]) {
-        throw std::logic_error("ArrayView::operator+ different dimensions used");
-      }
-    }
-    auto container = new Container(this->container_.size() - this->start_);
-    for (size_t i = 0; i != this->end_ - this->start_; ++i) {
-      container->operator[](i) = this->container_[this->start_ + i];
-      container->operator[](i) -= other.container_[other.start_ + i];
-    }
-    auto view = ArrayWithVectorsView(*container, 0, this->dimensions_);
 
-    return {view, container};
-  }
   template <typename... Args> requires Dimensions<Dimension, Args...>
   static VectorsViewWithContainer<Dimension, Container> MakeArray(Args... args) {
     auto container = new Container((args * ...));
@@ -67,75 +42,226 @@ class ArrayWithVectorsView: public ArrayView<Dimension, Container> {
   }
 };
 
-template <RandomAccessContainerWithVectors Container>
-class ArrayWithVectorsView<1, Container>: public ArrayView<1, Container> {
+template <size_t Dimension, RandomAccessContainerWithVectors Container>
+struct VectorsViewWithContainer {
+  ArrayWithVectorsView<Dimension, Container> view;
+  Container* container;
+};
+
+/*
+  Result of arithmetic on ArrayWithVectorsView, e.g. a + b * 3u - c.
+  Nothing is computed until the expression is assigned to a view (dst = a + b) or evaluated into a new array,
+  then the whole formula is computed in one pass, see expression.h
+ */
+template <size_t Dimension, RandomAccessContainerWithVectors Container, typename Node>
+class VectorsExpression {
  public:
-  using ArrayView<1, Container>::ArrayView;
-  VectorsViewWithContainer<1, Container> operator*(uint32_t lambda) {
-    auto container = new Container(this->container_.size() - this->start_);
-    for (size_t i = 0; i != this->end_ - this->start_; ++i) {
-      container->operator[](i) = this->container_[this->start_ + i];
-      container->operator[](i) *= lambda;
+  explicit VectorsExpression(const Node& node): node_(node) {}
+
+  [[nodiscard]] size_t GetDimension(size_t index) const { return node_.GetDimension(index); }
+  [[nodiscard]] size_t GetLength() const {
+    size_t length = 1;
+    for (size_t i = 0; i != Dimension; ++i) {
+      length *= node_.GetDimension(i);
     }
-    auto view = ArrayWithVectorsView<1, Container>(*container, 0, this->end_ - this->start_);
 
-    return {view, container};
+    return length;
   }
-  VectorsViewWithContainer<1, Container> operator+(const ArrayWithVectorsView<1, Container>& other) {
-    if (this->GetLength() != other.GetLength()) throw std::logic_error("ArrayView::operator+, they are not same length");
-    auto container = new Container(this->container_.size() - this->start_);
-    for (size_t i = 0; i != this->end_ - this->start_; ++i) {
-      container->operator[](i) = this->container_[this->start_ + i];
-      container->operator[](i) += other.container_[other.start_ + i];
+  [[nodiscard]] const Node& GetNode() const { return node_; }
+
+  VectorsViewWithContainer<Dimension, Container> Evaluate() const {
+    size_t dimensions[Dimension];
+    for (size_t i = 0; i != Dimension; ++i) {
+      dimensions[i] = node_.GetDimension(i);
     }
-    auto view = ArrayWithVectorsView<1, Container>(*container, 0, this->end_ - this->start_);
+    const auto length = GetLength();
+    auto container = new Container(length);
+    expression::EvaluateInto(node_, *container, 0, length);
+    auto view = ArrayWithVectorsView<Dimension, Container>(*container, 0, dimensions);
 
     return {view, container};
   }
-  VectorsViewWithContainer<1, Container> operator-(const ArrayWithVectorsView<1, Container>& other) {
-    if (this->GetLength() != other.GetLength()) throw std::logic_error("ArrayView::operator-, they are not same length");
-    auto container = new Container(this->container_.size() - this->start_);
-    for (size_t i = 0; i != this->end_ - this->start_; ++i) {
-      container->operator[](i) = this->container_[this->start_ + i];
-      container->operator[](i) -= other.container_[other.start_ + i];
+  void EvaluateInto(const ArrayWithVectorsView<Dimension, Container>& destination) const {
+    for (size_t i = 0; i != Dimension; ++i) {
+      if (destination.GetDimension(i) != node_.GetDimension(i)) {
+        throw std::logic_error("VectorsExpression::EvaluateInto different dimensions used");
+      }
     }
-    auto view = ArrayWithVectorsView<1, Container>(*container, 0, this->end_ - this->start_);
-
-    return {view, container};
+    expression::EvaluateInto(node_, destination.GetContainer(), destination.GetStart(), GetLength());
   }
-
-  static VectorsViewWithContainer<1, Container> MakeArray(size_t length) {
+  // parallel versions, see expression::EvaluateInto
+  VectorsViewWithContainer<Dimension, Container> Evaluate(ThreadPool& pool) const {
+    size_t dimensions[Dimension];
+    for (size_t i = 0; i != Dimension; ++i) {
+      dimensions[i] = node_.GetDimension(i);
+    }
+    const auto length = GetLength();
     auto container = new Container(length);
-    auto view = ArrayWithVectorsView<1, Container>(*container, 0, length);
+    expression::EvaluateInto(node_, *container, 0, length, pool);
+    auto view = ArrayWithVectorsView<Dimension, Container>(*container, 0, dimensions);
 
     return {view, container};
   }
+  void EvaluateInto(const ArrayWithVectorsView<Dimension, Container>& destination, ThreadPool& pool) const {
+    for (size_t i = 0; i != Dimension; ++i) {
+      if (destination.GetDimension(i) != node_.GetDimension(i)) {
+        throw std::logic_error("VectorsExpression::EvaluateInto different dimensions used");
+      }
+    }
+    expression::EvaluateInto(node_, destination.GetContainer(), destination.GetStart(), GetLength(), pool);
+  }
+
+ private:
+  Node node_;
 };
 
+template <typename T>
+struct VectorsOperandTraits {
+  static constexpr bool kIsOperand = false;
+};
 template <size_t Dimension, RandomAccessContainerWithVectors Container>
-struct VectorsViewWithContainer {
-  ArrayWithVectorsView<Dimension, Container> view;
-  Container* container;
+struct VectorsOperandTraits<ArrayWithVectorsView<Dimension, Container>> {
+  static constexpr bool kIsOperand = true;
+  static constexpr size_t kDimension = Dimension;
+  using ContainerType = Container;
+
+  static expression::Leaf<Dimension, Container> ToNode(const ArrayWithVectorsView<Dimension, Container>& view) {
+    size_t dimensions[Dimension];
+    for (size_t i = 0; i != Dimension; ++i) {
+      dimensions[i] = view.GetDimension(i);
+    }
+
+    return {view.GetContainer(), view.GetStart(), dimensions};
+  }
+};
+template <size_t Dimension, RandomAccessContainerWithVectors Container, typename Node>
+struct VectorsOperandTraits<VectorsExpression<Dimension, Container, Node>> {
+  static constexpr bool kIsOperand = true;
+  static constexpr size_t kDimension = Dimension;
+  using ContainerType = Container;
+
+  static const Node& ToNode(const VectorsExpression<Dimension, Container, Node>& expression) {
+    return expression.GetNode();
+  }
 };
 
+template <typename T>
+concept VectorsOperand = VectorsOperandTraits<T>::kIsOperand;
+// operands of any ranks over the same container type, dimensions are broadcast, see expression::Broadcast
+template <typename Lhs, typename Rhs>
+concept CompatibleVectorsOperands = VectorsOperand<Lhs> && VectorsOperand<Rhs>
+    && std::same_as<typename VectorsOperandTraits<Lhs>::ContainerType, typename VectorsOperandTraits<Rhs>::ContainerType>;
+// the operand of a compound assignment may be broadcast to the view, but not the other way round
+template <typename View, typename Operand>
+concept CompoundVectorsOperands = CompatibleVectorsOperands<View, Operand>
+    && VectorsOperandTraits<Operand>::kDimension <= VectorsOperandTraits<View>::kDimension;
+
+namespace detail {
+
+template <expression::Operation Op, typename Lhs, typename Rhs>
+auto MakeBinary(const Lhs& lhs, const Rhs& rhs) {
+  using LhsTraits = VectorsOperandTraits<Lhs>;
+  using RhsTraits = VectorsOperandTraits<Rhs>;
+  using LhsNode = std::remove_cvref_t<decltype(LhsTraits::ToNode(lhs))>;
+  using RhsNode = std::remove_cvref_t<decltype(RhsTraits::ToNode(rhs))>;
+  using Node = expression::Binary<Op, LhsNode, RhsNode>;
+
+  return VectorsExpression<Node::kDimension, typename LhsTraits::ContainerType, Node>(
+      Node(LhsTraits::ToNode(lhs), RhsTraits::ToNode(rhs)));
+}
+
+template <typename Operand>
+auto MakeScaled(const Operand& operand, uint32_t lambda) {
+  using Traits = VectorsOperandTraits<Operand>;
+  using Node = expression::Scaled<std::remove_cvref_t<decltype(Traits::ToNode(operand))>>;
+
+  return VectorsExpression<Traits::kDimension, typename Traits::ContainerType, Node>(Node(Traits::ToNode(operand), lambda));
+}
+
+}  // namespace detail
+
+template <typename Lhs, typename Rhs> requires CompatibleVectorsOperands<Lhs, Rhs>
+auto operator+(const Lhs& lhs, const Rhs& rhs) {
+  return detail::MakeBinary<expression::Operation::kAdd>(lhs, rhs);
+}
+template <typename Lhs, typename Rhs> requires CompatibleVectorsOperands<Lhs, Rhs>
+auto operator-(const Lhs& lhs, const Rhs& rhs) {
+  return detail::MakeBinary<expression::Operation::kSubtract>(lhs, rhs);
+}
+// element-wise product, wraps modulo 2^kBitLength like the other operations
+template <typename Lhs, typename Rhs> requires CompatibleVectorsOperands<Lhs, Rhs>
+auto operator*(const Lhs& lhs, const Rhs& rhs) {
+  return detail::MakeBinary<expression::Operation::kMultiply>(lhs, rhs);
+}
+template <VectorsOperand Operand>
+auto operator*(const Operand& operand, uint32_t lambda) {
+  return detail::MakeScaled(operand, lambda);
+}
+template <VectorsOperand Operand>
+auto operator*(uint32_t lambda, const Operand& operand) {
+  return detail::MakeScaled(operand, lambda);
+}
+
+/*
+  Compound assignment evaluates the expression straight into the view's container: no allocation, one pass.
+  other may have fewer axes or axes of size 1, it is broadcast over the view (volume += plane).
+  other may even be a part of the view (volume += plane 0 of volume): then the result goes through a temporary
+ */
+template <size_t Dimension, RandomAccessContainerWithVectors Container, typename Operand>
+  requires CompoundVectorsOperands<ArrayWithVectorsView<Dimension, Container>, Operand>
+ArrayWithVectorsView<Dimension, Container>& operator+=(ArrayWithVectorsView<Dimension, Container>& view,
+                                                       const Operand& other) {
+  return view = view + other;
+}
+template <size_t Dimension, RandomAccessContainerWithVectors Container, typename Operand>
+  requires CompoundVectorsOperands<ArrayWithVectorsView<Dimension, Container>, Operand>
+ArrayWithVectorsView<Dimension, Container>& operator-=(ArrayWithVectorsView<Dimension, Container>& view,
+                                                       const Operand& other) {
+  return view = view - other;
+}
+template <size_t Dimension, RandomAccessContainerWithVectors Container, typename Operand>
+  requires CompoundVectorsOperands<ArrayWithVectorsView<Dimension, Container>, Operand>
+ArrayWithVectorsView<Dimension, Container>& operator*=(ArrayWithVectorsView<Dimension, Container>& view,
+                                                       const Operand& other) {
+  return view = view * other;
+}
+template <size_t Dimension, RandomAccessContainerWithVectors Container>
+ArrayWithVectorsView<Dimension, Container>& operator+=(ArrayWithVectorsView<Dimension, Container>& view, uint32_t value) {
+  using Traits = VectorsOperandTraits<ArrayWithVectorsView<Dimension, Container>>;
+  using Node = expression::Shifted<decltype(Traits::ToNode(view))>;
+
+  return view = VectorsExpression<Dimension, Container, Node>(Node(Traits::ToNode(view), value));
+}
+template <size_t Dimension, RandomAccessContainerWithVectors Container>
+ArrayWithVectorsView<Dimension, Container>& operator-=(ArrayWithVectorsView<Dimension, Container>& view, uint32_t value) {
+  return view += (~value + 1);
+}
+template <size_t Dimension, RandomAccessContainerWithVectors Container>
+ArrayWithVectorsView<Dimension, Container>& operator*=(ArrayWithVectorsView<Dimension, Container>& view, uint32_t lambda) {
+  return view = view * lambda;
+}
+
 }  // namespace uint17
 
+// both go through the buffered codec of text_io.h
 template <size_t Dimension, uint17::RandomAccessContainer Container>
 std::ostream& operator<<(std::ostream& stream, const uint17::ArrayWithVectorsView<Dimension, Container>& view) {
-  Container& data = view.GetContainer();
-  for (size_t i = view.GetStart(); i != data.size() - 1; ++i) {
-    stream << data[i] << " ";
-  }
-  stream << data[data.size() - 1];
+  uint17::text::Write(stream, view);
 
   return stream;
 }
 
+// a malformed or too big number sets failbit, like extraction of a single number does
 template <size_t Dimension, uint17::RandomAccessContainer Container>
 std::istream& operator>>(std::istream& stream, uint17::ArrayWithVectorsView<Dimension, Container>& view) {
-  Container& data = view.GetContainer();
-  for (size_t i = view.GetStart(); i != data.size(); ++i) {
-    stream >> data[i];
+  const std::istream::sentry sentry(stream);
+  if (!sentry) {
+    return stream;
+  }
+  try {
+    uint17::text::Read(stream, view);
+  } catch (const uint17::text::ParseError&) {
+    stream.setstate(std::ios::failbit);
   }
 
   return stream;
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include "packing.h"
+
+namespace uint17 {
+
+namespace detail {
+
+inline uint64_t BigEndianToNative(uint64_t value) {  // and back, it is its own inverse
+  if constexpr (std::endian::native == std::endian::big) {
+    return value;
+  } else {
+    return __builtin_bswap64(value);
+  }
+}
+
+/*
+  Spin locks for numbers that straddle two 64-bit words, picked by the first word: only one number
+  can cross a given word border, so only operations on the same number (or a rare stripe collision) contend
+ */
+inline std::atomic_flag& StripeLock(const uint64_t* word) {
+  static std::atomic_flag locks[64];
+
+  return locks[reinterpret_cast<uintptr_t>(word) / sizeof(uint64_t) % 64];
+}
+
+class StripeLockGuard {
+ public:
+  explicit StripeLockGuard(const uint64_t* word): lock_(StripeLock(word)) {
+    while (lock_.test_and_set(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+  }
+  StripeLockGuard(const StripeLockGuard&) = delete;
+  StripeLockGuard& operator=(const StripeLockGuard&) = delete;
+  ~StripeLockGuard() { lock_.clear(std::memory_order_release); }
+
+ private:
+  std::atomic_flag& lock_;
+};
+
+}  // namespace detail
+
+/*
+  Same packed number as UIntNView<Bits>, but every operation is atomic: the number is updated
+  by compare-and-swap on the aligned 64-bit word(s) containing it, so neighbours sharing its bytes
+  are never overwritten and concurrent writers of adjacent numbers do not need a mutex.
+  A number inside one word is lock-free, a number crossing a word border updates both words by CAS
+  under a striped spin lock (17-bit numbers do so one time in about four).
+  Arithmetic wraps modulo 2^Bits. The aligned words around the number must be readable,
+  Array allocates whole words for that.
+
+    Array<AtomicUIntNView<17>> shared(n);  // or array.AtomicAt(i) on a plain Array
+    shared[i].FetchAdd(1);
+ */
+template <size_t Bits> requires (Bits >= 1 && Bits <= 32)
+class AtomicUIntNView {
+ public:
+  static constexpr size_t kBitLength = Bits;
+
+  AtomicUIntNView(uint8_t* data, uint8_t offset) {
+    const auto address = reinterpret_cast<uintptr_t>(data);
+    auto* word = reinterpret_cast<uint64_t*>(address - address % sizeof(uint64_t));
+    const auto position = (address % sizeof(uint64_t)) * CHAR_BIT + offset;  // from the most significant bit
+    if (position + Bits <= 64) {
+      parts_[0] = {word, static_cast<uint8_t>(64 - position - Bits), Bits, 0};
+      part_count_ = 1;
+    } else {
+      const auto high_bits = 64 - position;
+      const auto low_bits = Bits - high_bits;
+      parts_[0] = {word, 0, static_cast<uint8_t>(high_bits), static_cast<uint8_t>(low_bits)};
+      parts_[1] = {word + 1, static_cast<uint8_t>(64 - low_bits), static_cast<uint8_t>(low_bits), 0};
+      part_count_ = 2;
+    }
+  }
+  AtomicUIntNView(const AtomicUIntNView& other) = default;
+
+  [[nodiscard]] uint32_t Load() const {
+    if (part_count_ == 1) {
+      return parts_[0].Extract(std::atomic_ref(*parts_[0].word).load());
+    }
+    detail::StripeLockGuard guard(parts_[0].word);
+
+    return parts_[0].Extract(std::atomic_ref(*parts_[0].word).load())
+         | parts_[1].Extract(std::atomic_ref(*parts_[1].word).load());
+  }
+  void Store(uint32_t value) {
+    Update([value](uint32_t) { return value; });
+  }
+  uint32_t Exchange(uint32_t value) {
+    return Update([value](uint32_t) { return value; });
+  }
+  // all return the previous value
+  uint32_t FetchAdd(uint32_t value) {
+    return Update([value](uint32_t old) { return old + value; });
+  }
+  uint32_t FetchSub(uint32_t value) {
+    return Update([value](uint32_t old) { return old - value; });
+  }
+  uint32_t FetchMultiply(uint32_t value) {
+    return Update([value](uint32_t old) { return old * value; });
+  }
+  // stores desired if the number equals expected (both taken modulo 2^Bits), otherwise loads it into expected
+  bool CompareExchange(uint32_t& expected, uint32_t desired) {
+    bool exchanged = true;
+    const auto wanted = expected & packing::kMask<Bits>;
+    const auto old = Update([&](uint32_t current) {
+      exchanged = (current == wanted);
+
+      return exchanged ? desired : current;
+    });
+    expected = old;
+
+    return exchanged;
+  }
+
+  AtomicUIntNView& SetToZero() { return *this = uint32_t{0}; }
+  AtomicUIntNView& operator=(uint32_t number) {
+    Store(number);
+
+    return *this;
+  }
+  AtomicUIntNView& operator=(const AtomicUIntNView& other) { return *this = other.Load(); }
+  [[nodiscard]] uint32_t ToUInt32() const { return Load(); }
+  operator uint32_t() const { return Load(); }
+
+  AtomicUIntNView& operator+=(uint32_t other) {
+    FetchAdd(other);
+
+    return *this;
+  }
+  AtomicUIntNView& operator+=(const AtomicUIntNView& other) { return *this += other.Load(); }
+  AtomicUIntNView& operator-=(uint32_t other) {
+    FetchSub(other);
+
+    return *this;
+  }
+  AtomicUIntNView& operator-=(const AtomicUIntNView& other) { return *this -= other.Load(); }
+  AtomicUIntNView& operator*=(uint32_t other) {
+    FetchMultiply(other);
+
+    return *this;
+  }
+  AtomicUIntNView& operator*=(const AtomicUIntNView& other) { return *this *= other.Load(); }
+
+ private:
+  struct Part {  // width bits at shift of *word (counted in big-endian order) are bits [value_shift, ...) of the number
+    uint64_t* word;
+    uint8_t shift;
+    uint8_t width;
+    uint8_t value_shift;
+
+    [[nodiscard]] uint64_t Mask() const { return ((uint64_t{1} << width) - 1) << shift; }
+    [[nodiscard]] uint32_t Extract(uint64_t native) const {
+      return static_cast<uint32_t>((detail::BigEndianToNative(native) & Mask()) >> shift << value_shift);
+    }
+    [[nodiscard]] uint64_t Insert(uint64_t native, uint32_t value) const {
+      const auto bits = (static_cast<uint64_t>(value) >> value_shift << shift) & Mask();
+
+      return detail::BigEndianToNative((detail::BigEndianToNative(native) & ~Mask()) | bits);
+    }
+    void Store(uint32_t value) const {  // CAS only retries when neighbours in the word change concurrently
+      std::atomic_ref word_ref(*word);
+      auto current = word_ref.load(std::memory_order_relaxed);
+      while (!word_ref.compare_exchange_weak(current, Insert(current, value))) {
+      }
+    }
+  };
+
+  // atomically replaces the number by function(old) and returns old
+  template <typename Function>
+  uint32_t Update(Function&& function) {
+    if (part_count_ == 1) {
+      std::atomic_ref word_ref(*parts_[0].word);
+      auto current = word_ref.load(std::memory_order_relaxed);
+      while (true) {
+        const auto old = parts_[0].Extract(current);
+        if (word_ref.compare_exchange_weak(current, parts_[0].Insert(current, function(old) & packing::kMask<Bits>))) {
+          return old;
+        }
+      }
+    }
+    detail::StripeLockGuard guard(parts_[0].word);
+    const auto old = parts_[0].Extract(std::atomic_ref(*parts_[0].word).load())
+                   | parts_[1].Extract(std::atomic_ref(*parts_[1].word).load());
+    const auto value = function(old) & packing::kMask<Bits>;
+    parts_[0].Store(value);
+    parts_[1].Store(value);
+
+    return old;
+  }
+
+  Part parts_[2] = {};
+  size_t part_count_ = 0;
+};
+
+}  // namespace uint17
+
+template <size_t Bits>
+std::ostream& operator<<(std::ostream& stream, const uint17::AtomicUIntNView<Bits>& value) {
+  stream << value.Load();
+
+  return stream;
+}
@@ -0,0 +1,335 @@
+#pragma once
+
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "array.h"
+#include "array_view.h"
+#include "kernels.h"
+#include "mapped_array.h"
+#include "packing.h"
+#include "uint_n_view.h"
+
+/*
+  Binary file format, all header fields little-endian:
+
+    offset  size        field
+    0       4           magic "A3DV"
+    4       2           version (kBinaryVersion)
+    6       1           bit length of a number
+    7       1           rank
+    8       4           flags, bit 0: checksum is valid
+    12      8           number of elements
+    20      8           FNV-1a 64 checksum of the data bytes (0 when not computed)
+    28      8 * rank    dimensions, outermost first
+    28 + 8 * rank       data: the packed bit stream of packing.h, ceil(length * bits / 8) bytes
+
+  The data is exactly the bytes Array keeps in memory, so loading is a single read (or a mapping)
+  and saving a byte-aligned view is a single write.
+ */
+namespace uint17::binary {
+
+inline constexpr char kMagic[4] = {'A', '3', 'D', 'V'};
+constexpr uint16_t kVersion = 1;
+constexpr uint32_t kChecksumFlag = 1;
+constexpr size_t kFixedHeaderSize = 28;
+
+class FormatError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+struct Header {
+  uint16_t version = kVersion;
+  size_t bit_length = 0;
+  std::vector<size_t> dimensions;
+  size_t length = 0;
+  bool has_checksum = false;
+  uint64_t checksum = 0;
+
+  [[nodiscard]] size_t GetRank() const { return dimensions.size(); }
+  [[nodiscard]] size_t GetSize() const { return kFixedHeaderSize + 8 * dimensions.size(); }  // offset of the data
+  [[nodiscard]] size_t GetDataSize() const { return (length * bit_length + CHAR_BIT - 1) / CHAR_BIT; }
+};
+
+class Checksum {  // FNV-1a, 64 bit
+ public:
+  void Update(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i != length; ++i) {
+      hash_ = (hash_ ^ data[i]) * 0x100000001b3ULL;
+    }
+  }
+  [[nodiscard]] uint64_t Get() const { return hash_; }
+
+ private:
+  uint64_t hash_ = 0xcbf29ce484222325ULL;
+};
+
+namespace detail {
+
+// containers storing the plain packed stream of packing.h
+template <typename T>
+concept PackedContainer = requires(const T t) {
+  { t.Data() } -> std::same_as<const uint8_t*>;
+  { t.size() } -> std::same_as<size_t>;
+} && PackedNumberView<std::remove_cvref_t<decltype(std::declval<T&>()[size_t{}])>>;
+
+template <typename Container>
+constexpr size_t kBitLength = std::remove_cvref_t<decltype(std::declval<Container&>()[size_t{}])>::kBitLength;
+
+inline void PutLittleEndian(uint8_t* out, uint64_t value, size_t bytes) {
+  for (size_t i = 0; i != bytes; ++i) {
+    out[i] = static_cast<uint8_t>(value >> (CHAR_BIT * i));
+  }
+}
+
+inline uint64_t GetLittleEndian(const uint8_t* in, size_t bytes) {
+  uint64_t value = 0;
+  for (size_t i = bytes; i != 0; --i) {
+    value = (value << CHAR_BIT) | in[i - 1];
+  }
+
+  return value;
+}
+
+inline std::vector<uint8_t> EncodeHeader(const Header& header) {
+  std::vector<uint8_t> bytes(header.GetSize());
+  std::memcpy(bytes.data(), kMagic, sizeof(kMagic));
+  PutLittleEndian(bytes.data() + 4, header.version, 2);
+  PutLittleEndian(bytes.data() + 6, header.bit_length, 1);
+  PutLittleEndian(bytes.data() + 7, header.GetRank(), 1);
+  PutLittleEndian(bytes.data() + 8, header.has_checksum ? kChecksumFlag : 0, 4);
+  PutLittleEndian(bytes.data() + 12, header.length, 8);
+  PutLittleEndian(bytes.data() + 20, header.checksum, 8);
+  for (size_t i = 0; i != header.GetRank(); ++i) {
+    PutLittleEndian(bytes.data() + kFixedHeaderSize + 8 * i, header.dimensions[i], 8);
+  }
+
+  return bytes;
+}
+
+// bytes left after the current position, SIZE_MAX if the stream cannot seek
+inline size_t RemainingBytes(std::istream& stream) {
+  const auto position = stream.tellg();
+  if (position == std::streampos(-1)) {
+    return SIZE_MAX;
+  }
+  stream.seekg(0, std::ios::end);
+  const auto end = stream.tellg();
+  stream.clear();
+  stream.seekg(position);
+  if (end == std::streampos(-1) || end < position) {
+    return SIZE_MAX;
+  }
+
+  return static_cast<size_t>(end - position);
+}
+
+inline void Write(std::ostream& stream, const uint8_t* data, size_t length) {
+  if (!stream.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(length))) {
+    throw std::runtime_error("binary::Save, write failed");
+  }
+}
+
+/*
+  Passes numbers [start, start + length) of container as a standalone bit stream to function(bytes, size) piece by piece.
+  If number start begins on a byte boundary the container bytes are passed as they are,
+  otherwise the numbers are re-packed block by block. Trailing bits of the last byte are zeros
+ */
+template <PackedContainer Container, typename Function>
+void ForEachDataPiece(const Container& container, size_t start, size_t length, Function&& function) {
+  constexpr size_t kBits = kBitLength<Container>;
+  const auto bits = length * kBits;
+  if (start * kBits % CHAR_BIT == 0) {
+    const auto* first = container.Data() + start * kBits / CHAR_BIT;
+    const auto whole_bytes = bits / CHAR_BIT;
+    function(first, whole_bytes);
+    if (bits % CHAR_BIT != 0) {
+      const auto last = static_cast<uint8_t>(first[whole_bytes] & (0xFF << (CHAR_BIT - bits % CHAR_BIT)));
+      function(&last, size_t{1});
+    }
+    return;
+  }
+  uint32_t lanes[kernels::kBlockLength];
+  uint8_t bytes[kernels::kBlockLength * kBits / CHAR_BIT + packing::kTailSlack];  // kBlockLength is a whole number of groups
+  for (size_t i = 0; i < length; i += kernels::kBlockLength) {
+    const auto block = (length - i < kernels::kBlockLength) ? length - i : kernels::kBlockLength;
+    const auto block_bytes = (block * kBits + CHAR_BIT - 1) / CHAR_BIT;
+    container.Unpack(start + i, block, lanes);
+    std::memset(bytes, 0, block_bytes + packing::kTailSlack);
+    packing::Pack<kBits>(bytes, lanes, 0, block);
+    function(static_cast<const uint8_t*>(bytes), block_bytes);
+  }
+}
+
+template <PackedContainer Container>
+void Save(std::ostream& stream, const Container& container, size_t start, const size_t* dimensions, size_t rank,
+          bool with_checksum) {
+  if (rank > UINT8_MAX) {
+    throw std::invalid_argument("binary::Save, rank does not fit into the header");
+  }
+  Header header;
+  header.bit_length = kBitLength<Container>;
+  header.dimensions.assign(dimensions, dimensions + rank);
+  header.length = 1;
+  for (size_t i = 0; i != rank; ++i) {
+    header.length *= dimensions[i];
+  }
+  header.has_checksum = with_checksum;
+  if (with_checksum) {  // the data is in memory, so the checksum goes into the header and pipes need no seeking back
+    Checksum checksum;
+    ForEachDataPiece(container, start, header.length, [&](const uint8_t* bytes, size_t size) {
+      checksum.Update(bytes, size);
+    });
+    header.checksum = checksum.Get();
+  }
+  const auto encoded = EncodeHeader(header);
+  Write(stream, encoded.data(), encoded.size());
+  ForEachDataPiece(container, start, header.length, [&](const uint8_t* bytes, size_t size) {
+    Write(stream, bytes, size);
+  });
+}
+
+}  // namespace detail
+
+inline Header ReadHeader(std::istream& stream) {
+  uint8_t fixed[kFixedHeaderSize];
+  if (!stream.read(reinterpret_cast<char*>(fixed), sizeof(fixed))) {
+    throw FormatError("binary::ReadHeader, truncated header");
+  }
+  if (std::memcmp(fixed, kMagic, sizeof(kMagic)) != 0) {
+    throw FormatError("binary::ReadHeader, wrong magic");
+  }
+  Header header;
+  header.version = static_cast<uint16_t>(detail::GetLittleEndian(fixed + 4, 2));
+  if (header.version != kVersion) {
+    throw FormatError("binary::ReadHeader, unsupported version " + std::to_string(header.version));
+  }
+  header.bit_length = detail::GetLittleEndian(fixed + 6, 1);
+  const auto rank = detail::GetLittleEndian(fixed + 7, 1);
+  header.has_checksum = (detail::GetLittleEndian(fixed + 8, 4) & kChecksumFlag) != 0;
+  header.length = detail::GetLittleEndian(fixed + 12, 8);
+  header.checksum = detail::GetLittleEndian(fixed + 20, 8);
+
+  std::vector<uint8_t> dimensions(8 * rank);
+  if (!stream.read(reinterpret_cast<char*>(dimensions.data()), static_cast<std::streamsize>(dimensions.size()))) {
+    throw FormatError("binary::ReadHeader, truncated header");
+  }
+  size_t length = 1;
+  for (size_t i = 0; i != rank; ++i) {
+    const auto dimension = detail::GetLittleEndian(dimensions.data() + 8 * i, 8);
+    if (dimension != 0 && length > SIZE_MAX / dimension) {  // a wrapped product could match a small length
+      throw FormatError("binary::ReadHeader, dimensions overflow");
+    }
+    header.dimensions.push_back(dimension);
+    length *= dimension;
+  }
+  if (header.bit_length < 1 || header.bit_length > 32 || length != header.length) {
+    throw FormatError("binary::ReadHeader, inconsistent header");
+  }
+  if (header.length > (SIZE_MAX - CHAR_BIT - packing::kTailSlack) / header.bit_length) {  // bits of the data
+    throw FormatError("binary::ReadHeader, length overflow");
+  }
+
+  return header;
+}
+
+// whole container as a rank 1 volume
+template <detail::PackedContainer Container>
+void Save(std::ostream& stream, const Container& container, bool with_checksum = true) {
+  const size_t length = container.size();
+  detail::Save(stream, container, 0, &length, 1, with_checksum);
+}
+
+template <size_t Dimension, detail::PackedContainer Container>
+void Save(std::ostream& stream, const ArrayView<Dimension, Container>& view, bool with_checksum = true) {
+  size_t dimensions[Dimension];
+  for (size_t i = 0; i != Dimension; ++i) {
+    dimensions[i] = view.GetDimension(i);
+  }
+  detail::Save(stream, view.GetContainer(), view.GetStart(), dimensions, Dimension, with_checksum);
+}
+
+template <typename Object>
+void Save(const std::string& path, const Object& object, bool with_checksum = true) {
+  std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+  if (!stream) {
+    throw std::runtime_error("binary::Save, cannot open " + path);
+  }
+  Save(stream, object, with_checksum);
+}
+
+/*
+  Reads a file written by Save into a new Array with one read of the data bytes.
+  View::kBitLength must match the file, dimensions are returned through header.
+  A length longer than what is left in the stream is rejected before allocating. If the stream cannot seek,
+  the buffer is kLazyZero, so a truncated stream takes memory only for the bytes actually read
+ */
+template <NumberView View = UInt17View> requires PackedNumberView<View>
+Array<View> Load(std::istream& stream, Header* header = nullptr, bool verify_checksum = true) {
+  auto file_header = ReadHeader(stream);
+  if (file_header.bit_length != View::kBitLength) {
+    throw FormatError("binary::Load, file stores " + std::to_string(file_header.bit_length) + "-bit numbers");
+  }
+  const auto remaining = detail::RemainingBytes(stream);
+  if (remaining != SIZE_MAX && remaining < file_header.GetDataSize()) {
+    throw FormatError("binary::Load, truncated data");
+  }
+  Array<View> array(file_header.length,
+                    (remaining == SIZE_MAX) ? Initialization::kLazyZero : Initialization::kUninitialized);
+  if (!stream.read(reinterpret_cast<char*>(array.Data()), static_cast<std::streamsize>(array.SizeInBytes()))) {
+    throw FormatError("binary::Load, truncated data");
+  }
+  if (verify_checksum && file_header.has_checksum) {
+    Checksum checksum;
+    checksum.Update(array.Data(), array.SizeInBytes());
+    if (checksum.Get() != file_header.checksum) {
+      throw FormatError("binary::Load, checksum mismatch");
+    }
+  }
+  if (header != nullptr) {
+    *header = std::move(file_header);
+  }
+
+  return array;
+}
+
+template <NumberView View = UInt17View> requires PackedNumberView<View>
+Array<View> Load(const std::string& path, Header* header = nullptr, bool verify_checksum = true) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    throw std::runtime_error("binary::Load, cannot open " + path);
+  }
+
+  return Load<View>(stream, header, verify_checksum);
+}
+
+// maps the data of a file written by Save in place, nothing is read until it is accessed, the checksum is not verified
+template <NumberView View = UInt17View> requires PackedNumberView<View>
+MappedArray<View> Map(const std::string& path, Header* header = nullptr, MapMode mode = MapMode::kReadOnly) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    throw std::runtime_error("binary::Map, cannot open " + path);
+  }
+  auto file_header = ReadHeader(stream);
+  if (file_header.bit_length != View::kBitLength) {
+    throw FormatError("binary::Map, file stores " + std::to_string(file_header.bit_length) + "-bit numbers");
+  }
+  auto array = MappedArray<View>::Open(path, file_header.length, mode, file_header.GetSize());
+  if (header != nullptr) {
+    *header = std::move(file_header);
+  }
+
+  return array;
+}
+
+}  // namespace uint17::binary
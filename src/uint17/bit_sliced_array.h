@@ -0,0 +1,312 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "array.h"
+#include "array_view.h"
+#include "expression.h"
+#include "uint_n_view.h"
+
+namespace uint17 {
+
+enum class Comparison { kLess, kLessOrEqual, kEqual, kNotEqual, kGreaterOrEqual, kGreater };
+
+/*
+  Array of Bits-bit numbers stored as bit planes: numbers are taken in slices of 64, and a slice is Bits words,
+  word b holding bit b of all 64 numbers (bit l of the word belongs to number 64 * slice + l).
+  Takes the same Bits bits per number as Array, but comparisons with a constant, range predicates,
+  addition and subtraction work on whole words, 64 numbers per instruction, without decoding anything.
+  Predicates return a Mask with one bit per number in the same order, counted with popcount.
+  Single numbers are gathered from / scattered to Bits words, which is slower than Array.
+  Parallel stores into it are split on slices (kWriteAlignment), since a write changes words shared by 64 numbers.
+
+    auto sliced = BitSlicedArray<17>::From(array);
+    const auto hot = sliced.CountInRange(1000, 2000);
+    sliced += 5u;
+ */
+template <size_t Bits = 17> requires (Bits >= 1 && Bits <= 32)
+class BitSlicedArray {
+ public:
+  static constexpr size_t kBitLength = Bits;
+  static constexpr size_t kSliceLength = 64;
+  static constexpr size_t kWriteAlignment = kSliceLength;  // Pack rewrites whole plane words
+
+  using Mask = std::vector<uint64_t>;  // bit l of word s is number 64 * s + l
+
+  class ConstReference {
+   public:
+    ConstReference(const BitSlicedArray& array, size_t index): array_(&array), index_(index) {}
+
+    [[nodiscard]] uint32_t ToUInt32() const { return array_->Get(index_); }
+    operator uint32_t() const { return ToUInt32(); }
+
+   private:
+    const BitSlicedArray* array_;
+    size_t index_;
+  };
+
+  class Reference {
+   public:
+    static constexpr size_t kBitLength = Bits;
+
+    Reference(BitSlicedArray& array, size_t index): array_(&array), index_(index) {}
+    Reference(const Reference& other) = default;
+
+    Reference& operator=(uint32_t number) {  // overflow ignored
+      array_->Set(index_, number);
+
+      return *this;
+    }
+    Reference& operator=(const Reference& other) { return *this = other.ToUInt32(); }
+    [[nodiscard]] uint32_t ToUInt32() const { return array_->Get(index_); }
+    operator uint32_t() const { return ToUInt32(); }
+
+    Reference& operator+=(uint32_t other) { return *this = ToUInt32() + other; }
+    Reference& operator+=(const Reference& other) { return *this += other.ToUInt32(); }
+    Reference& operator-=(uint32_t other) { return *this = ToUInt32() - other; }
+    Reference& operator-=(const Reference& other) { return *this -= other.ToUInt32(); }
+    Reference& operator*=(uint32_t other) { return *this = ToUInt32() * other; }
+    Reference& operator*=(const Reference& other) { return *this *= other.ToUInt32(); }
+
+   private:
+    BitSlicedArray* array_;
+    size_t index_;
+  };
+
+  // length zeros
+  explicit BitSlicedArray(size_t length)
+    : length_(length), words_((length + kSliceLength - 1) / kSliceLength * Bits) {}
+
+  // converters from any container (e.g. Array<UIntNView<Bits>>) and to Array
+  template <RandomAccessContainer Container>
+  static BitSlicedArray From(const Container& source) {
+    BitSlicedArray result(source.size());
+    uint32_t lanes[kSliceLength];
+    for (size_t begin = 0; begin < result.length_; begin += kSliceLength) {
+      const auto count = std::min(kSliceLength, result.length_ - begin);
+      expression::LoadRange(source, begin, count, lanes);
+      result.Pack(lanes, begin, count);
+    }
+
+    return result;
+  }
+  [[nodiscard]] Array<UIntNView<Bits>> ToArray() const {
+    Array<UIntNView<Bits>> result(length_);
+    uint32_t lanes[kSliceLength];
+    for (size_t begin = 0; begin < length_; begin += kSliceLength) {
+      const auto count = std::min(kSliceLength, length_ - begin);
+      Unpack(begin, count, lanes);
+      result.Pack(lanes, begin, count);
+    }
+
+    return result;
+  }
+
+  [[nodiscard]] size_t size() const { return length_; }
+  [[nodiscard]] size_t SizeInBytes() const { return words_.size() * sizeof(uint64_t); }
+
+  Reference operator[](size_t index) { return Reference(*this, index); }
+  ConstReference operator[](size_t index) const { return ConstReference(*this, index); }
+  Reference At(size_t index) {
+    if (index >= length_) {
+      throw std::out_of_range("BitSlicedArray::at");
+    }
+
+    return Reference(*this, index);
+  }
+  ConstReference At(size_t index) const {
+    if (index >= length_) {
+      throw std::out_of_range("BitSlicedArray::at");
+    }
+
+    return ConstReference(*this, index);
+  }
+
+  [[nodiscard]] uint32_t Get(size_t index) const {
+    const auto* planes = words_.data() + index / kSliceLength * Bits;
+    const auto lane = index % kSliceLength;
+    uint32_t result = 0;
+    for (size_t b = 0; b != Bits; ++b) {
+      result |= static_cast<uint32_t>((planes[b] >> lane) & 1) << b;
+    }
+
+    return result;
+  }
+  void Set(size_t index, uint32_t number) {
+    auto* planes = words_.data() + index / kSliceLength * Bits;
+    const auto lane = index % kSliceLength;
+    for (size_t b = 0; b != Bits; ++b) {
+      planes[b] = (planes[b] & ~(uint64_t{1} << lane)) | (static_cast<uint64_t>((number >> b) & 1) << lane);
+    }
+  }
+
+  // bulk access as Array::Unpack / Array::Pack
+  void Unpack(size_t begin, size_t count, uint32_t* out) const {
+    if (begin > length_ || count > length_ - begin) {
+      throw std::out_of_range("BitSlicedArray::Unpack");
+    }
+    for (size_t i = 0; i != count; ++i) {
+      out[i] = 0;
+    }
+    for (size_t b = 0; b != Bits; ++b) {  // plane by plane, the inner loop over lanes has no dependencies
+      for (size_t i = 0; i != count; ++i) {
+        const auto index = begin + i;
+        out[i] |= static_cast<uint32_t>((words_[index / kSliceLength * Bits + b] >> (index % kSliceLength)) & 1) << b;
+      }
+    }
+  }
+  void Pack(const uint32_t* in, size_t begin, size_t count) {
+    if (begin > length_ || count > length_ - begin) {
+      throw std::out_of_range("BitSlicedArray::Pack");
+    }
+    size_t i = 0;
+    while (i != count) {
+      const auto index = begin + i;
+      const auto lane = index % kSliceLength;
+      const auto part = std::min(kSliceLength - lane, count - i);
+      const auto keep = ~(LowBits(part) << lane);
+      auto* planes = words_.data() + index / kSliceLength * Bits;
+      for (size_t b = 0; b != Bits; ++b) {
+        uint64_t plane = 0;
+        for (size_t l = 0; l != part; ++l) {
+          plane |= static_cast<uint64_t>((in[i + l] >> b) & 1) << l;
+        }
+        planes[b] = (planes[b] & keep) | (plane << lane);
+      }
+      i += part;
+    }
+  }
+
+  // numbers compared with value, one bit per number
+  [[nodiscard]] Mask Compare(Comparison comparison, uint32_t value) const {
+    Mask result(SliceCount());
+    for (size_t s = 0; s != result.size(); ++s) {
+      uint64_t less, equal;
+      CompareSlice(s, value, less, equal);
+      uint64_t word = 0;
+      switch (comparison) {
+        case Comparison::kLess: word = less; break;
+        case Comparison::kLessOrEqual: word = less | equal; break;
+        case Comparison::kEqual: word = equal; break;
+        case Comparison::kNotEqual: word = ~equal; break;
+        case Comparison::kGreaterOrEqual: word = ~less; break;
+        case Comparison::kGreater: word = ~(less | equal); break;
+      }
+      result[s] = word & ValidLanes(s);
+    }
+
+    return result;
+  }
+  // low <= number <= high
+  [[nodiscard]] Mask InRange(uint32_t low, uint32_t high) const {
+    Mask result(SliceCount());
+    for (size_t s = 0; s != result.size(); ++s) {
+      uint64_t below, low_equal, less, equal;
+      CompareSlice(s, low, below, low_equal);
+      CompareSlice(s, high, less, equal);
+      result[s] = ~below & (less | equal) & ValidLanes(s);
+    }
+
+    return result;
+  }
+  [[nodiscard]] size_t Count(Comparison comparison, uint32_t value) const { return Count(Compare(comparison, value)); }
+  [[nodiscard]] size_t CountInRange(uint32_t low, uint32_t high) const { return Count(InRange(low, high)); }
+  static size_t Count(const Mask& mask) {
+    size_t result = 0;
+    for (const auto word : mask) {
+      result += static_cast<size_t>(std::popcount(word));
+    }
+
+    return result;
+  }
+
+  /*
+    Ripple-carry addition and subtraction on the planes, 64 numbers at a time, modulo 2^Bits like Array.
+    Numbers past size() in the last slice change too, but are never visible
+   */
+  BitSlicedArray& operator+=(const BitSlicedArray& other) {
+    CheckLength(other, "BitSlicedArray::operator+= different lengths used");
+    for (size_t s = 0; s != SliceCount(); ++s) {
+      AddSlice(s, other.words_.data() + s * Bits, 0, 0);
+    }
+
+    return *this;
+  }
+  BitSlicedArray& operator-=(const BitSlicedArray& other) {
+    CheckLength(other, "BitSlicedArray::operator-= different lengths used");
+    for (size_t s = 0; s != SliceCount(); ++s) {  // a - b = a + ~b + 1
+      AddSlice(s, other.words_.data() + s * Bits, ~uint64_t{0}, ~uint64_t{0});
+    }
+
+    return *this;
+  }
+  BitSlicedArray& operator+=(uint32_t value) {
+    uint64_t planes[Bits];
+    for (size_t b = 0; b != Bits; ++b) {
+      planes[b] = ((value >> b) & 1) ? ~uint64_t{0} : 0;
+    }
+    for (size_t s = 0; s != SliceCount(); ++s) {
+      AddSlice(s, planes, 0, 0);
+    }
+
+    return *this;
+  }
+  BitSlicedArray& operator-=(uint32_t value) { return *this += (~value + 1); }
+
+ private:
+  static uint64_t LowBits(size_t count) { return (count == kSliceLength) ? ~uint64_t{0} : (uint64_t{1} << count) - 1; }
+
+  [[nodiscard]] size_t SliceCount() const { return words_.size() / Bits; }
+  [[nodiscard]] uint64_t ValidLanes(size_t slice) const {
+    return (slice + 1 == SliceCount()) ? LowBits(length_ - slice * kSliceLength) : ~uint64_t{0};
+  }
+
+  // from the most significant plane down: lanes still equal to value decide on the first differing bit
+  void CompareSlice(size_t slice, uint32_t value, uint64_t& less, uint64_t& equal) const {
+    const auto* planes = words_.data() + slice * Bits;
+    less = 0;
+    equal = ~uint64_t{0};
+    if constexpr (Bits < 32) {
+      if (value >> Bits != 0) {  // value does not fit, every number is smaller
+        less = ~uint64_t{0};
+        equal = 0;
+        return;
+      }
+    }
+    for (size_t b = Bits; b != 0; --b) {
+      const auto plane = planes[b - 1];
+      if ((value >> (b - 1)) & 1) {
+        less |= equal & ~plane;
+        equal &= plane;
+      } else {
+        equal &= ~plane;
+      }
+    }
+  }
+
+  // slice += (rhs ^ invert) + carry, bit by bit with full adders on whole words
+  void AddSlice(size_t slice, const uint64_t* rhs, uint64_t invert, uint64_t carry) {
+    auto* planes = words_.data() + slice * Bits;
+    for (size_t b = 0; b != Bits; ++b) {
+      const auto a = planes[b];
+      const auto c = rhs[b] ^ invert;
+      planes[b] = a ^ c ^ carry;
+      carry = (a & c) | (carry & (a ^ c));
+    }
+  }
+
+  void CheckLength(const BitSlicedArray& other, const char* message) const {
+    if (other.length_ != length_) {
+      throw std::logic_error(message);
+    }
+  }
+
+  size_t length_;
+  std::vector<uint64_t> words_;  // Bits planes of every slice of 64 numbers
+};
+
+}  // namespace uint17
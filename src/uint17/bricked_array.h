@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "array.h"
+#include "array_view.h"
+#include "expression.h"
+#include "uint17_view.h"
+
+namespace uint17 {
+
+/*
+  3D array stored as bricks of 8 x 8 x 8 numbers instead of row-major order.
+  A brick is 512 consecutive numbers (17 cache lines of 17-bit numbers), so all 26 neighbours
+  of a number and small boxes around it are usually in the same brick, and stepping along the slowest axis
+  moves 64 numbers instead of a whole plane. Dimensions are padded up to multiples of 8 internally.
+  Element access is the same as for ArrayView<3>: volume[i][j][k] (checked) and volume(i, j, k) (unchecked).
+
+    BrickedArray volume = BrickedArray<>::FromRowMajor(view);
+    volume(i, j, k + 1) += volume(i + 1, j, k);
+    volume.ToRowMajor(view);
+ */
+template <NumberView View = UInt17View>
+class BrickedArray {
+ public:
+  static constexpr size_t kBrickEdge = 8;
+  static constexpr size_t kBrickLength = kBrickEdge * kBrickEdge * kBrickEdge;
+
+  template <bool IsConst>
+  class Row {
+   public:
+    using Owner = std::conditional_t<IsConst, const BrickedArray, BrickedArray>;
+
+    Row(Owner& owner, size_t i, size_t j): owner_(&owner), i_(i), j_(j) {}
+
+    decltype(auto) operator[](size_t k) const {
+      if (k >= owner_->GetDimension(2)) {
+        throw std::out_of_range("BrickedArray::operator[]");
+      }
+
+      return (*owner_)(i_, j_, k);
+    }
+
+   private:
+    Owner* owner_;
+    size_t i_;
+    size_t j_;
+  };
+
+  template <bool IsConst>
+  class Plane {
+   public:
+    using Owner = std::conditional_t<IsConst, const BrickedArray, BrickedArray>;
+
+    Plane(Owner& owner, size_t i): owner_(&owner), i_(i) {}
+
+    Row<IsConst> operator[](size_t j) const {
+      if (j >= owner_->GetDimension(1)) {
+        throw std::out_of_range("BrickedArray::operator[]");
+      }
+
+      return Row<IsConst>(*owner_, i_, j);
+    }
+
+   private:
+    Owner* owner_;
+    size_t i_;
+  };
+
+  BrickedArray(size_t dimension0, size_t dimension1, size_t dimension2)
+    : dimensions_{dimension0, dimension1, dimension2},
+      bricks_{BricksFor(dimension0), BricksFor(dimension1), BricksFor(dimension2)},
+      data_(bricks_[0] * bricks_[1] * bricks_[2] * kBrickLength, Initialization::kZero) {}
+
+  // copies a row-major 3D view into bricks
+  template <RandomAccessContainer Container>
+  static BrickedArray FromRowMajor(const ArrayView<3, Container>& view) {
+    BrickedArray result(view.GetDimension(0), view.GetDimension(1), view.GetDimension(2));
+    const auto length = result.dimensions_[2];
+    std::vector<uint32_t> row(result.bricks_[2] * kBrickEdge);  // tail past length stays zero
+    for (size_t i = 0; i != result.dimensions_[0]; ++i) {
+      for (size_t j = 0; j != result.dimensions_[1]; ++j) {
+        expression::LoadRange(view.GetContainer(), view.GetStart() + i * view.GetStride(0) + j * view.GetStride(1),
+                              length, row.data());
+        for (size_t k = 0; k < length; k += kBrickEdge) {  // one brick row of 8 numbers is one whole group
+          result.data_.Pack(row.data() + k, result.Offset(i, j, k), kBrickEdge);
+        }
+      }
+    }
+
+    return result;
+  }
+
+  // copies the numbers into a row-major 3D view of the same dimensions
+  template <RandomAccessContainer Container>
+  void ToRowMajor(const ArrayView<3, Container>& view) const {
+    for (size_t axis = 0; axis != 3; ++axis) {
+      if (view.GetDimension(axis) != dimensions_[axis]) {
+        throw std::logic_error("BrickedArray::ToRowMajor different dimensions used");
+      }
+    }
+    const auto length = dimensions_[2];
+    std::vector<uint32_t> row(bricks_[2] * kBrickEdge);
+    for (size_t i = 0; i != dimensions_[0]; ++i) {
+      for (size_t j = 0; j != dimensions_[1]; ++j) {
+        for (size_t k = 0; k < length; k += kBrickEdge) {
+          data_.Unpack(Offset(i, j, k), kBrickEdge, row.data() + k);
+        }
+        expression::StoreRange(view.GetContainer(), view.GetStart() + i * view.GetStride(0) + j * view.GetStride(1),
+                               length, row.data());
+      }
+    }
+  }
+  // new row-major array with the same numbers, the caller owns the container as with MakeArray
+  [[nodiscard]] ViewWithContainer<3, Array<View>> ToRowMajor() const {
+    auto result = ArrayView<3, Array<View>>::MakeArray(dimensions_[0], dimensions_[1], dimensions_[2]);
+    ToRowMajor(result.view);
+
+    return result;
+  }
+
+  Plane<false> operator[](size_t i) {
+    if (i >= dimensions_[0]) {
+      throw std::out_of_range("BrickedArray::operator[]");
+    }
+
+    return Plane<false>(*this, i);
+  }
+  Plane<true> operator[](size_t i) const {
+    if (i >= dimensions_[0]) {
+      throw std::out_of_range("BrickedArray::operator[]");
+    }
+
+    return Plane<true>(*this, i);
+  }
+  // unchecked access to element (i, j, k)
+  View operator()(size_t i, size_t j, size_t k) { return data_[Offset(i, j, k)]; }
+  const View operator()(size_t i, size_t j, size_t k) const { return data_[Offset(i, j, k)]; }
+
+  [[nodiscard]] size_t GetDimension(size_t index) const { return dimensions_[index]; }
+  [[nodiscard]] size_t GetLength() const { return dimensions_[0] * dimensions_[1] * dimensions_[2]; }
+  // brick storage, numbers of the padding are zeros
+  [[nodiscard]] Array<View>& GetContainer() { return data_; }
+  [[nodiscard]] const Array<View>& GetContainer() const { return data_; }
+
+  // index of (i, j, k) in the container: brick number * 512 + position inside the brick
+  [[nodiscard]] size_t Offset(size_t i, size_t j, size_t k) const {
+    const auto brick = ((i / kBrickEdge) * bricks_[1] + j / kBrickEdge) * bricks_[2] + k / kBrickEdge;
+    const auto inside = ((i % kBrickEdge) * kBrickEdge + j % kBrickEdge) * kBrickEdge + k % kBrickEdge;
+
+    return brick * kBrickLength + inside;
+  }
+
+ private:
+  static size_t BricksFor(size_t dimension) { return (dimension + kBrickEdge - 1) / kBrickEdge; }
+
+  size_t dimensions_[3];
+  size_t bricks_[3];  // number of bricks along each axis
+  Array<View> data_;
+};
+
+}  // namespace uint17
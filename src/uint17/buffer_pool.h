@@ -0,0 +1,97 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "utils.h"
+
+namespace uint17 {
+
+/*
+  Cache of freed buffers grouped by size class, so temporaries of the same size that are created
+  and destroyed every frame reuse memory that is already mapped instead of going to the global allocator.
+  Size classes are quarter steps between powers of two, a buffer is at most 25% bigger than requested.
+  Buffers are cache-line aligned like those of Array.
+  Buffers acquired from the pool may be released to it from any thread, the pool must outlive them.
+  Reset() gives the cached buffers back to the system, e.g. when a pipeline changes volume sizes
+ */
+class BufferPool {
+ public:
+  static constexpr size_t kMinClassSize = 64;
+
+  BufferPool() = default;
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+  ~BufferPool() { Reset(); }
+
+  static size_t ClassSize(size_t size) {
+    if (size <= kMinClassSize) {
+      return kMinClassSize;
+    }
+    const auto step = std::bit_floor(size - 1) / 4;
+
+    return (size + step - 1) / step * step;
+  }
+
+  // buffer of at least size bytes, contents are unspecified
+  uint8_t* Acquire(size_t size) {
+    const auto class_size = ClassSize(size);
+    {
+      std::lock_guard lock(mutex_);
+      auto& buffers = free_[class_size];
+      if (!buffers.empty()) {
+        auto* buffer = buffers.back();
+        buffers.pop_back();
+        cached_bytes_ -= class_size;
+        ++reused_count_;
+
+        return buffer;
+      }
+    }
+
+    return utils::AllocateAligned(class_size);
+  }
+  // size must be the size the buffer was acquired with
+  void Release(uint8_t* buffer, size_t size) {
+    if (buffer == nullptr) {
+      return;
+    }
+    const auto class_size = ClassSize(size);
+    std::lock_guard lock(mutex_);
+    free_[class_size].push_back(buffer);
+    cached_bytes_ += class_size;
+  }
+  // frees the cached buffers, buffers in use stay valid and come back to the pool when released
+  void Reset() {
+    std::lock_guard lock(mutex_);
+    for (auto& [class_size, buffers] : free_) {
+      for (auto* buffer : buffers) {
+        utils::FreeAligned(buffer);
+      }
+    }
+    free_.clear();
+    cached_bytes_ = 0;
+  }
+
+  [[nodiscard]] size_t GetCachedBytes() const {
+    std::lock_guard lock(mutex_);
+
+    return cached_bytes_;
+  }
+  [[nodiscard]] size_t GetReusedCount() const {  // acquisitions served from the cache
+    std::lock_guard lock(mutex_);
+
+    return reused_count_;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::map<size_t, std::vector<uint8_t*>> free_;  // class size -> cached buffers
+  size_t cached_bytes_ = 0;
+  size_t reused_count_ = 0;
+};
+
+}  // namespace uint17
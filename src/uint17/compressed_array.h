@@ -0,0 +1,289 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "array_view.h"
+#include "expression.h"
+#include "kernels.h"
+#include "packing.h"
+#include "utils.h"
+
+namespace uint17 {
+
+namespace detail {
+
+// calls function.template operator()<W>() for the runtime width 1 <= width <= Bits, so the packing kernels get a constant
+template <size_t Bits, typename Function>
+void WithWidth(size_t width, Function&& function) {
+  [&]<size_t... W>(std::index_sequence<W...>) {
+    static_cast<void>(((width == W + 1 ? (function.template operator()<W + 1>(), true) : false) || ...));
+  }(std::make_index_sequence<Bits>{});
+}
+
+}  // namespace detail
+
+/*
+  Read-mostly array of Bits-bit numbers compressed with frame of reference: every block of kBlockLength numbers
+  is stored as its smallest number (the base) and the differences from it packed with just enough bits
+  for the largest difference, so a block of numbers within 0..511 of each other takes 9 bits per number
+  and a block of equal numbers takes none. The block index costs 1 bit per number.
+  Reading a number is a lookup of its block and one word load. Unpack decodes whole blocks with the packing kernels,
+  Pack and writes that do not fit into the width of their block re-encode the block, which moves the following blocks
+  of its segment (kSegmentBlocks blocks share a buffer), so writes are much slower than reads.
+  Satisfies RandomAccessContainerWithVectors, so views and expressions work on it; parallel evaluation into it
+  runs on one thread (kWriteAlignment is 0), since re-encoding a block resizes the buffer of the segment.
+
+    auto compressed = CompressedArray<17>::From(array);
+    ArrayView<3, CompressedArray<17>> volume(compressed, 0, 512u, 512u, 512u);
+ */
+template <size_t Bits = 17> requires (Bits >= 1 && Bits <= 32)
+class CompressedArray {
+ public:
+  static constexpr size_t kBitLength = Bits;
+  static constexpr size_t kBlockLength = 128;  // 16 groups, so a block of any width takes whole bytes
+  static constexpr size_t kSegmentBlocks = 64;  // blocks whose data share a buffer, offsets are relative to it
+  static constexpr size_t kWriteAlignment = 0;
+
+  class ConstReference {
+   public:
+    ConstReference(const CompressedArray& array, size_t index): array_(&array), index_(index) {}
+
+    [[nodiscard]] uint32_t ToUInt32() const { return array_->Get(index_); }
+    operator uint32_t() const { return ToUInt32(); }
+
+   private:
+    const CompressedArray* array_;
+    size_t index_;
+  };
+
+  class Reference {
+   public:
+    static constexpr size_t kBitLength = Bits;
+
+    Reference(CompressedArray& array, size_t index): array_(&array), index_(index) {}
+    Reference(const Reference& other) = default;
+
+    Reference& operator=(uint32_t number) {  // overflow ignored
+      array_->Set(index_, number);
+
+      return *this;
+    }
+    Reference& operator=(const Reference& other) { return *this = other.ToUInt32(); }
+    [[nodiscard]] uint32_t ToUInt32() const { return array_->Get(index_); }
+    operator uint32_t() const { return ToUInt32(); }
+
+    Reference& operator+=(uint32_t other) { return *this = ToUInt32() + other; }
+    Reference& operator+=(const Reference& other) { return *this += other.ToUInt32(); }
+    Reference& operator-=(uint32_t other) { return *this = ToUInt32() - other; }
+    Reference& operator-=(const Reference& other) { return *this -= other.ToUInt32(); }
+    Reference& operator*=(uint32_t other) { return *this = ToUInt32() * other; }
+    Reference& operator*=(const Reference& other) { return *this *= other.ToUInt32(); }
+
+   private:
+    CompressedArray* array_;
+    size_t index_;
+  };
+
+  // length zeros, every block has width 0 and takes no data
+  explicit CompressedArray(size_t length)
+    : length_(length), blocks_((length + kBlockLength - 1) / kBlockLength),
+      segments_((blocks_.size() + kSegmentBlocks - 1) / kSegmentBlocks, std::vector<uint8_t>(packing::kTailSlack)) {}
+
+  // compresses the numbers of any container, e.g. Array<UInt17View>, numbers are truncated to Bits bits
+  template <RandomAccessContainer Container>
+  static CompressedArray From(const Container& source) {
+    CompressedArray result(source.size());
+    uint32_t values[kBlockLength];
+    for (size_t b = 0; b != result.blocks_.size(); ++b) {
+      const auto count = result.BlockCount(b);
+      auto& block = result.blocks_[b];
+      auto& segment = result.segments_[b / kSegmentBlocks];
+      expression::LoadRange(source, b * kBlockLength, count, values);
+      for (size_t i = 0; i != count; ++i) {  // a wider source keeps its low Bits bits, as with Set and Pack
+        values[i] &= packing::kMask<Bits>;
+      }
+      block.offset = segment.size() - packing::kTailSlack;  // the block goes where the slack was
+      segment.resize(segment.size() + Encode(values, count, block));
+      Write(values, count, block, segment.data() + block.offset);
+    }
+
+    return result;
+  }
+
+  [[nodiscard]] size_t size() const { return length_; }
+  // memory taken by the packed differences and the block index
+  [[nodiscard]] size_t SizeInBytes() const {
+    auto result = blocks_.size() * sizeof(Block);
+    for (const auto& segment : segments_) {
+      result += segment.size() - packing::kTailSlack;
+    }
+
+    return result;
+  }
+  // bits per number of the block containing index
+  [[nodiscard]] size_t GetWidth(size_t index) const { return blocks_[index / kBlockLength].width; }
+
+  Reference operator[](size_t index) { return Reference(*this, index); }
+  ConstReference operator[](size_t index) const { return ConstReference(*this, index); }
+  Reference At(size_t index) {
+    if (index >= length_) {
+      throw std::out_of_range("CompressedArray::at");
+    }
+
+    return Reference(*this, index);
+  }
+  ConstReference At(size_t index) const {
+    if (index >= length_) {
+      throw std::out_of_range("CompressedArray::at");
+    }
+
+    return ConstReference(*this, index);
+  }
+
+  [[nodiscard]] uint32_t Get(size_t index) const {
+    const auto& block = blocks_[index / kBlockLength];
+    if (block.width == 0) {
+      return block.base;
+    }
+    const auto bit = (index % kBlockLength) * block.width;
+    const auto word = utils::LoadBigEndian64(BlockData(index / kBlockLength) + bit / CHAR_BIT);
+
+    return block.base + static_cast<uint32_t>((word << (bit % CHAR_BIT)) >> (64 - block.width));
+  }
+  // writes in place if number - base fits into the width of the block, otherwise re-encodes the block
+  void Set(size_t index, uint32_t number) {
+    number &= packing::kMask<Bits>;
+    const auto b = index / kBlockLength;
+    auto& block = blocks_[b];
+    const auto delta = static_cast<uint64_t>(number) - block.base;
+    if (number >= block.base && delta < (uint64_t{1} << block.width)) {
+      if (block.width != 0) {
+        detail::WithWidth<Bits>(block.width, [&]<size_t W>() {
+          packing::WriteValue<W>(BlockData(b), index % kBlockLength, static_cast<uint32_t>(delta));
+        });
+      }
+      return;
+    }
+    uint32_t values[kBlockLength];
+    DecodeBlock(b, 0, BlockCount(b), values);
+    values[index % kBlockLength] = number;
+    ReplaceBlock(b, values);
+  }
+
+  // bulk access as Array::Unpack / Array::Pack, one decode per block
+  void Unpack(size_t begin, size_t count, uint32_t* out) const {
+    if (begin > length_ || count > length_ - begin) {
+      throw std::out_of_range("CompressedArray::Unpack");
+    }
+    while (count != 0) {
+      const auto b = begin / kBlockLength;
+      const auto first = begin % kBlockLength;
+      const auto part = std::min(count, BlockCount(b) - first);
+      DecodeBlock(b, first, part, out);
+      begin += part;
+      count -= part;
+      out += part;
+    }
+  }
+  void Pack(const uint32_t* in, size_t begin, size_t count) {
+    if (begin > length_ || count > length_ - begin) {
+      throw std::out_of_range("CompressedArray::Pack");
+    }
+    uint32_t values[kBlockLength];
+    while (count != 0) {
+      const auto b = begin / kBlockLength;
+      const auto first = begin % kBlockLength;
+      const auto part = std::min(count, BlockCount(b) - first);
+      if (part != BlockCount(b)) {  // a block written partly keeps its other numbers
+        DecodeBlock(b, 0, BlockCount(b), values);
+      }
+      for (size_t i = 0; i != part; ++i) {
+        values[first + i] = in[i] & packing::kMask<Bits>;
+      }
+      ReplaceBlock(b, values);
+      begin += part;
+      count -= part;
+      in += part;
+    }
+  }
+
+ private:
+  struct Block {
+    uint64_t offset = 0;  // of the packed differences in the buffer of the segment
+    uint32_t base = 0;
+    uint8_t width = 0;
+  };
+
+  [[nodiscard]] size_t BlockCount(size_t b) const {
+    return (b + 1 == blocks_.size() && length_ % kBlockLength != 0) ? length_ % kBlockLength : kBlockLength;
+  }
+  static size_t BlockBytes(size_t count, size_t width) { return (count * width + CHAR_BIT - 1) / CHAR_BIT; }
+  [[nodiscard]] uint8_t* BlockData(size_t b) { return segments_[b / kSegmentBlocks].data() + blocks_[b].offset; }
+  [[nodiscard]] const uint8_t* BlockData(size_t b) const {
+    return segments_[b / kSegmentBlocks].data() + blocks_[b].offset;
+  }
+
+  // chooses base and width of values, returns the bytes the block needs
+  static size_t Encode(const uint32_t* values, size_t count, Block& block) {
+    const auto [min, max] = std::minmax_element(values, values + count);
+    block.base = *min;
+    block.width = static_cast<uint8_t>(std::bit_width(*max - *min));
+
+    return BlockBytes(count, block.width);
+  }
+  // packs values - base into bytes, which hold BlockBytes(count, width) zeros or stale bits
+  static void Write(uint32_t* values, size_t count, const Block& block, uint8_t* bytes) {
+    if (block.width == 0) {
+      return;
+    }
+    kernels::AddScalar(values, ~block.base + 1, values, count);
+    std::memset(bytes, 0, BlockBytes(count, block.width));
+    detail::WithWidth<Bits>(block.width, [&]<size_t W>() { packing::Pack<W>(bytes, values, 0, count); });
+  }
+
+  void DecodeBlock(size_t b, size_t first, size_t count, uint32_t* out) const {
+    const auto& block = blocks_[b];
+    if (block.width == 0) {
+      std::fill(out, out + count, block.base);
+      return;
+    }
+    detail::WithWidth<Bits>(block.width, [&]<size_t W>() {
+      packing::Unpack<W>(BlockData(b), first, count, out);
+    });
+    kernels::AddScalar(out, block.base, out, count);
+  }
+
+  // re-encodes block b from values (clobbered), the data of the following blocks of its segment moves if its size changes
+  void ReplaceBlock(size_t b, uint32_t* values) {
+    const auto count = BlockCount(b);
+    auto& block = blocks_[b];
+    auto& segment = segments_[b / kSegmentBlocks];
+    const auto old_bytes = BlockBytes(count, block.width);
+    const auto new_bytes = Encode(values, count, block);
+    if (new_bytes > old_bytes) {
+      segment.insert(segment.begin() + static_cast<std::ptrdiff_t>(block.offset + old_bytes), new_bytes - old_bytes, 0);
+    } else if (new_bytes < old_bytes) {
+      segment.erase(segment.begin() + static_cast<std::ptrdiff_t>(block.offset + new_bytes),
+                    segment.begin() + static_cast<std::ptrdiff_t>(block.offset + old_bytes));
+    }
+    const auto segment_end = std::min(blocks_.size(), (b / kSegmentBlocks + 1) * kSegmentBlocks);
+    for (size_t next = b + 1; next != segment_end; ++next) {
+      blocks_[next].offset = blocks_[next].offset + new_bytes - old_bytes;
+    }
+    Write(values, count, block, segment.data() + block.offset);
+  }
+
+  size_t length_;
+  std::vector<Block> blocks_;
+  // packed differences of kSegmentBlocks consecutive blocks followed by packing::kTailSlack bytes
+  std::vector<std::vector<uint8_t>> segments_;
+};
+
+}  // namespace uint17
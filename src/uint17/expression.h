@@ -0,0 +1,322 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include "array_view.h"
+#include "kernels.h"
+#include "packing.h"
+#include "thread_pool.h"
+
+/*
+  Lazy arithmetic on views. Operators build a tree of nodes (leaves are views, inner nodes are operations),
+  nothing is computed until the tree is evaluated into a destination. Evaluation walks the destination once,
+  block by block: every node fills a block of uint32_t lanes for positions [offset, offset + length),
+  so a whole formula costs one pass and no intermediate containers.
+  Operands of a binary operation are broadcast like in NumPy: dimensions are matched from the last axis,
+  missing leading axes and axes of size 1 are repeated, see Broadcast.
+ */
+namespace uint17::expression {
+
+enum class Operation { kAdd, kSubtract, kMultiply };
+
+template <typename Container>
+void LoadRange(const Container& container, size_t begin, size_t length, uint32_t* out) {
+  if constexpr (BulkReadableContainer<Container>) {
+    container.Unpack(begin, length, out);
+  } else {
+    for (size_t i = 0; i != length; ++i) {
+      out[i] = container[begin + i].ToUInt32();
+    }
+  }
+}
+
+template <typename Container>
+void StoreRange(Container& container, size_t begin, size_t length, const uint32_t* in) {
+  if constexpr (BulkWritableContainer<Container>) {
+    container.Pack(in, begin, length);
+  } else {
+    for (size_t i = 0; i != length; ++i) {
+      container[begin + i] = in[i];
+    }
+  }
+}
+
+template <size_t Dimension, RandomAccessContainer Container>
+class Leaf {
+ public:
+  static constexpr size_t kDimension = Dimension;
+  using ContainerType = Container;
+
+  Leaf(Container& container, size_t start, const size_t* dimensions): container_(&container), start_(start) {
+    for (size_t i = 0; i != Dimension; ++i) {
+      dimensions_[i] = dimensions[i];
+    }
+  }
+
+  [[nodiscard]] size_t GetDimension(size_t index) const { return dimensions_[index]; }
+  void Load(size_t offset, size_t length, uint32_t* out) const {
+    LoadRange(*container_, start_ + offset, length, out);
+  }
+  // true if the leaf reads some of [start, start + length) of container, but not exactly these positions
+  template <typename Other>
+  [[nodiscard]] bool Overlaps(const Other& container, size_t start, size_t length) const {
+    if constexpr (std::same_as<const Other, const Container>) {
+      size_t own = 1;
+      for (const auto dimension : dimensions_) {
+        own *= dimension;
+      }
+
+      return container_ == &container && start_ < start + length && start < start_ + own &&
+             (start_ != start || own != length);
+    } else {
+      return false;
+    }
+  }
+
+ private:
+  Container* container_;
+  size_t start_;
+  size_t dimensions_[Dimension];
+};
+
+/*
+  Operand seen with the (larger or equal) dimensions of a binary operation. Positions of the result are mapped
+  to the operand in runs: the longest suffix of axes that the operand has in full is loaded contiguously,
+  a suffix of repeated axes is one number filled over the run. E.g. a (d1, d2) plane added to a (d0, d1, d2) volume
+  is loaded plane by plane, a (d0, d1, 1) column is one number per row of d2. An operand of the same dimensions
+  loads straight through. The operand may lie inside the destination (volume += its own plane),
+  EvaluateInto detects that through Overlaps and goes through a temporary
+ */
+template <typename Operand, size_t Dimension>
+class Broadcast {
+ public:
+  static_assert(Operand::kDimension <= Dimension);
+
+  Broadcast(const Operand& operand, const size_t* dimensions): operand_(operand) {
+    constexpr auto kMissing = Dimension - Operand::kDimension;
+    size_t stride = 1;
+    is_same_ = (kMissing == 0);
+    for (size_t i = Dimension; i != 0; --i) {
+      dimensions_[i - 1] = dimensions[i - 1];
+      const auto own = (i - 1 < kMissing) ? 1 : operand_.GetDimension(i - 1 - kMissing);
+      strides_[i - 1] = (own == dimensions[i - 1]) ? stride : 0;
+      stride *= own;
+      is_same_ = is_same_ && own == dimensions[i - 1];
+    }
+    // run_length_: numbers of the longest suffix of axes that are all loaded or all repeated
+    run_length_ = 1;
+    bool decided = false;
+    for (size_t i = Dimension; i != 0; --i) {
+      if (dimensions_[i - 1] == 1) {
+        continue;
+      }
+      const auto repeated = (strides_[i - 1] == 0);
+      if (decided && repeated != is_repeated_) {
+        break;
+      }
+      is_repeated_ = repeated;
+      decided = true;
+      run_length_ *= dimensions_[i - 1];
+    }
+  }
+
+  template <typename Container>
+  [[nodiscard]] bool Overlaps(const Container& container, size_t start, size_t length) const {
+    return operand_.Overlaps(container, start, length);
+  }
+  void Load(size_t offset, size_t length, uint32_t* out) const {
+    if (is_same_) {
+      operand_.Load(offset, length, out);
+      return;
+    }
+    while (length != 0) {
+      const auto run = std::min(run_length_ - offset % run_length_, length);
+      size_t source = 0;
+      size_t rest = offset;
+      for (size_t i = Dimension; i != 0; --i) {
+        source += rest % dimensions_[i - 1] * strides_[i - 1];
+        rest /= dimensions_[i - 1];
+      }
+      if (is_repeated_) {
+        operand_.Load(source, 1, out);
+        std::fill(out + 1, out + run, out[0]);
+      } else {
+        operand_.Load(source, run, out);
+      }
+      offset += run;
+      out += run;
+      length -= run;
+    }
+  }
+
+ private:
+  Operand operand_;
+  size_t dimensions_[Dimension];  // of the result
+  size_t strides_[Dimension];  // of the operand along the result axes, 0 for repeated axes
+  size_t run_length_;
+  bool is_repeated_ = false;
+  bool is_same_;
+};
+
+template <Operation Op, typename Lhs, typename Rhs>
+class Binary {
+ public:
+  static constexpr size_t kDimension = (Lhs::kDimension > Rhs::kDimension) ? Lhs::kDimension : Rhs::kDimension;
+  using ContainerType = typename Lhs::ContainerType;
+
+  Binary(const Lhs& lhs, const Rhs& rhs): Binary(lhs, rhs, BroadcastDimensions(lhs, rhs)) {}
+
+  [[nodiscard]] size_t GetDimension(size_t index) const { return dimensions_[index]; }
+  template <typename Container>
+  [[nodiscard]] bool Overlaps(const Container& container, size_t start, size_t length) const {
+    return lhs_.Overlaps(container, start, length) || rhs_.Overlaps(container, start, length);
+  }
+  void Load(size_t offset, size_t length, uint32_t* out) const {
+    uint32_t rhs_lanes[kernels::kBlockLength];
+    lhs_.Load(offset, length, out);
+    rhs_.Load(offset, length, rhs_lanes);
+    if constexpr (Op == Operation::kAdd) {
+      kernels::Add(out, rhs_lanes, out, length);
+    } else if constexpr (Op == Operation::kSubtract) {
+      kernels::Subtract(out, rhs_lanes, out, length);
+    } else {
+      kernels::Multiply(out, rhs_lanes, out, length);
+    }
+  }
+
+ private:
+  struct Dimensions {
+    size_t data[kDimension];
+  };
+
+  Binary(const Lhs& lhs, const Rhs& rhs, const Dimensions& dimensions)
+    : lhs_(lhs, dimensions.data), rhs_(rhs, dimensions.data) {
+    for (size_t i = 0; i != kDimension; ++i) {
+      dimensions_[i] = dimensions.data[i];
+    }
+  }
+
+  // axes are matched from the last one, sizes must be equal or one of them 1 (a missing axis is 1)
+  static Dimensions BroadcastDimensions(const Lhs& lhs, const Rhs& rhs) {
+    Dimensions result{};
+    for (size_t i = 0; i != kDimension; ++i) {
+      const auto lhs_size = (i < kDimension - Lhs::kDimension) ? 1 : lhs.GetDimension(i - (kDimension - Lhs::kDimension));
+      const auto rhs_size = (i < kDimension - Rhs::kDimension) ? 1 : rhs.GetDimension(i - (kDimension - Rhs::kDimension));
+      if (lhs_size != rhs_size && lhs_size != 1 && rhs_size != 1) {
+        throw std::logic_error(Op == Operation::kAdd        ? "ArrayView::operator+ different dimensions used"
+                               : Op == Operation::kSubtract ? "ArrayView::operator- different dimensions used"
+                                                            : "ArrayView::operator* different dimensions used");
+      }
+      result.data[i] = (lhs_size == 1) ? rhs_size : lhs_size;
+    }
+
+    return result;
+  }
+
+  Broadcast<Lhs, kDimension> lhs_;
+  Broadcast<Rhs, kDimension> rhs_;
+  size_t dimensions_[kDimension];
+};
+
+template <typename Operand>
+class Scaled {
+ public:
+  static constexpr size_t kDimension = Operand::kDimension;
+  using ContainerType = typename Operand::ContainerType;
+
+  Scaled(const Operand& operand, uint32_t lambda): operand_(operand), lambda_(lambda) {}
+
+  [[nodiscard]] size_t GetDimension(size_t index) const { return operand_.GetDimension(index); }
+  template <typename Container>
+  [[nodiscard]] bool Overlaps(const Container& container, size_t start, size_t length) const {
+    return operand_.Overlaps(container, start, length);
+  }
+  void Load(size_t offset, size_t length, uint32_t* out) const {
+    operand_.Load(offset, length, out);
+    kernels::Scale(out, lambda_, out, length);
+  }
+
+ private:
+  Operand operand_;
+  uint32_t lambda_;
+};
+
+template <typename Operand>
+class Shifted {  // operand + value, subtraction of a scalar is addition of its 2^32 complement
+ public:
+  static constexpr size_t kDimension = Operand::kDimension;
+  using ContainerType = typename Operand::ContainerType;
+
+  Shifted(const Operand& operand, uint32_t value): operand_(operand), value_(value) {}
+
+  [[nodiscard]] size_t GetDimension(size_t index) const { return operand_.GetDimension(index); }
+  template <typename Container>
+  [[nodiscard]] bool Overlaps(const Container& container, size_t start, size_t length) const {
+    return operand_.Overlaps(container, start, length);
+  }
+  void Load(size_t offset, size_t length, uint32_t* out) const {
+    operand_.Load(offset, length, out);
+    kernels::AddScalar(out, value_, out, length);
+  }
+
+ private:
+  Operand operand_;
+  uint32_t value_;
+};
+
+constexpr size_t kParallelMinPiece = 64 * kernels::kBlockLength;  // smaller pieces cost more to schedule than to compute
+
+// writes positions [begin, end) of node into container, position p goes to index start + p
+template <typename Node, typename Container>
+void EvaluateRange(const Node& node, Container& container, size_t start, size_t begin, size_t end) {
+  uint32_t lanes[kernels::kBlockLength];
+  for (size_t i = begin; i < end; i += kernels::kBlockLength) {
+    const auto block = (end - i < kernels::kBlockLength) ? end - i : kernels::kBlockLength;
+    node.Load(i, block, lanes);
+    StoreRange(container, start + i, block, lanes);
+  }
+}
+
+/*
+  Writes node into [start, start + length) of container.
+  Every leaf block is loaded before the block is stored, so the destination may be one of the leaves
+  as long as it covers exactly the same positions (a += b). A leaf reading other positions of the destination
+  (volume += plane 0 of the same volume, a shifted view) would see numbers already overwritten,
+  so then the node is evaluated into a temporary container first and copied
+ */
+template <typename Node, typename Container>
+void EvaluateInto(const Node& node, Container& container, size_t start, size_t length) {
+  if (node.Overlaps(container, start, length)) {
+    std::remove_const_t<Container> result(length);
+    EvaluateRange(node, result, 0, 0, length);
+    EvaluateRange(Leaf<1, decltype(result)>(result, 0, &length), container, start, 0, length);
+    return;
+  }
+  EvaluateRange(node, container, start, 0, length);
+}
+
+/*
+  Same on the threads of pool. The destination is split on group boundaries (kGroupLength numbers
+  take a whole number of bytes, see kWriteAlignment for other containers), so no byte is written by two threads.
+  Sources may be shared freely, sources overlapping the destination go through a temporary as above,
+  but a source next to the destination must not share a byte with it
+ */
+template <typename Node, typename Container>
+void EvaluateInto(const Node& node, Container& container, size_t start, size_t length, ThreadPool& pool) {
+  if (node.Overlaps(container, start, length)) {
+    std::remove_const_t<Container> result(length);
+    EvaluateInto(node, result, 0, length, pool);
+    EvaluateInto(Leaf<1, decltype(result)>(result, 0, &length), container, start, length, pool);
+    return;
+  }
+  PrepareForWrite(container);
+  ParallelForRange(pool, start, length, kWriteAlignment<Container>, kParallelMinPiece, [&](size_t begin, size_t end) {
+    EvaluateRange(node, container, start, begin, end);
+  });
+}
+
+}  // namespace uint17::expression
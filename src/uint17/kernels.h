@@ -0,0 +1,285 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/*
+  Arithmetic on decoded numbers (one uint32_t lane per number).
+  Everything wraps modulo 2^32, packing back truncates to View::kBitLength bits,
+  which is exactly wrapping modulo 2^kBitLength, so no masking is needed here.
+  Explicit AVX2 / SSE paths are used when the compiler targets them (see ARRAY3D_ENABLE_AVX2),
+  the scalar tail loops are simple enough for the auto-vectorizer otherwise.
+ */
+namespace uint17::kernels {
+
+constexpr size_t kBlockLength = 512;  // numbers decoded at once, a block of lanes stays in L1
+
+inline void Add(const uint32_t* lhs, const uint32_t* rhs, uint32_t* out, size_t length) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  for (; length - i >= 8; i += 8) {
+    const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+    const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi32(a, b));
+  }
+#elif defined(__SSE2__)
+  for (; length - i >= 4; i += 4) {
+    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+    const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi32(a, b));
+  }
+#endif
+  for (; i != length; ++i) {
+    out[i] = lhs[i] + rhs[i];
+  }
+}
+
+inline void Subtract(const uint32_t* lhs, const uint32_t* rhs, uint32_t* out, size_t length) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  for (; length - i >= 8; i += 8) {
+    const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+    const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_sub_epi32(a, b));
+  }
+#elif defined(__SSE2__)
+  for (; length - i >= 4; i += 4) {
+    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+    const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_sub_epi32(a, b));
+  }
+#endif
+  for (; i != length; ++i) {
+    out[i] = lhs[i] - rhs[i];
+  }
+}
+
+inline void Multiply(const uint32_t* lhs, const uint32_t* rhs, uint32_t* out, size_t length) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  for (; length - i >= 8; i += 8) {
+    const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+    const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_mullo_epi32(a, b));
+  }
+#elif defined(__SSE4_1__)
+  for (; length - i >= 4; i += 4) {
+    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+    const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_mullo_epi32(a, b));
+  }
+#endif
+  for (; i != length; ++i) {
+    out[i] = lhs[i] * rhs[i];
+  }
+}
+
+inline void AddScalar(const uint32_t* lhs, uint32_t value, uint32_t* out, size_t length) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  const auto addend = _mm256_set1_epi32(static_cast<int>(value));
+  for (; length - i >= 8; i += 8) {
+    const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi32(a, addend));
+  }
+#elif defined(__SSE2__)
+  const auto addend = _mm_set1_epi32(static_cast<int>(value));
+  for (; length - i >= 4; i += 4) {
+    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi32(a, addend));
+  }
+#endif
+  for (; i != length; ++i) {
+    out[i] = lhs[i] + value;
+  }
+}
+
+inline void Scale(const uint32_t* lhs, uint32_t lambda, uint32_t* out, size_t length) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  const auto factor = _mm256_set1_epi32(static_cast<int>(lambda));
+  for (; length - i >= 8; i += 8) {
+    const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_mullo_epi32(a, factor));
+  }
+#elif defined(__SSE4_1__)
+  const auto factor = _mm_set1_epi32(static_cast<int>(lambda));
+  for (; length - i >= 4; i += 4) {
+    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_mullo_epi32(a, factor));
+  }
+#endif
+  for (; i != length; ++i) {
+    out[i] = lhs[i] * lambda;
+  }
+}
+
+// result[i] += lhs[i] * lambda, the multiply-add of weighted sums such as stencils
+inline void MultiplyAdd(uint32_t* result, const uint32_t* lhs, uint32_t lambda, size_t length) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  const auto factor = _mm256_set1_epi32(static_cast<int>(lambda));
+  for (; length - i >= 8; i += 8) {
+    const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+    const auto r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(result + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), _mm256_add_epi32(r, _mm256_mullo_epi32(a, factor)));
+  }
+#elif defined(__SSE4_1__)
+  const auto factor = _mm_set1_epi32(static_cast<int>(lambda));
+  for (; length - i >= 4; i += 4) {
+    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+    const auto r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(result + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), _mm_add_epi32(r, _mm_mullo_epi32(a, factor)));
+  }
+#endif
+  for (; i != length; ++i) {
+    result[i] += lhs[i] * lambda;
+  }
+}
+
+// lanes[i] = int32(lanes[i]) / divisor, so weighted sums with negative weights are divided as signed numbers
+inline void DivideSigned(uint32_t* lanes, int32_t divisor, size_t length) {
+  for (size_t i = 0; i != length; ++i) {
+    lanes[i] = static_cast<uint32_t>(static_cast<int32_t>(lanes[i]) / divisor);
+  }
+}
+
+/*
+  Reductions. Sums and dot products widen to 64 bits, so 2^32 numbers of 32 bits cannot overflow them
+ */
+inline uint64_t Sum(const uint32_t* lhs, size_t length) {
+  size_t i = 0;
+  uint64_t result = 0;
+#if defined(__AVX2__)
+  auto sums = _mm256_setzero_si256();
+  const auto zero = _mm256_setzero_si256();
+  for (; length - i >= 8; i += 8) {
+    const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+    sums = _mm256_add_epi64(sums, _mm256_unpacklo_epi32(a, zero));
+    sums = _mm256_add_epi64(sums, _mm256_unpackhi_epi32(a, zero));
+  }
+  uint64_t parts[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(parts), sums);
+  result = parts[0] + parts[1] + parts[2] + parts[3];
+#elif defined(__SSE2__)
+  auto sums = _mm_setzero_si128();
+  const auto zero = _mm_setzero_si128();
+  for (; length - i >= 4; i += 4) {
+    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+    sums = _mm_add_epi64(sums, _mm_unpacklo_epi32(a, zero));
+    sums = _mm_add_epi64(sums, _mm_unpackhi_epi32(a, zero));
+  }
+  uint64_t parts[2];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(parts), sums);
+  result = parts[0] + parts[1];
+#endif
+  for (; i != length; ++i) {
+    result += lhs[i];
+  }
+
+  return result;
+}
+
+inline uint64_t Dot(const uint32_t* lhs, const uint32_t* rhs, size_t length) {
+  size_t i = 0;
+  uint64_t result = 0;
+#if defined(__AVX2__)
+  auto sums = _mm256_setzero_si256();
+  for (; length - i >= 8; i += 8) {
+    const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+    const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+    sums = _mm256_add_epi64(sums, _mm256_mul_epu32(a, b));  // even lanes
+    sums = _mm256_add_epi64(sums, _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32)));  // odd lanes
+  }
+  uint64_t parts[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(parts), sums);
+  result = parts[0] + parts[1] + parts[2] + parts[3];
+#elif defined(__SSE2__)
+  auto sums = _mm_setzero_si128();
+  for (; length - i >= 4; i += 4) {
+    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+    const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+    sums = _mm_add_epi64(sums, _mm_mul_epu32(a, b));
+    sums = _mm_add_epi64(sums, _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32)));
+  }
+  uint64_t parts[2];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(parts), sums);
+  result = parts[0] + parts[1];
+#endif
+  for (; i != length; ++i) {
+    result += static_cast<uint64_t>(lhs[i]) * rhs[i];
+  }
+
+  return result;
+}
+
+// sums[i] += lhs[i], for reductions along an axis
+inline void Accumulate(uint64_t* sums, const uint32_t* lhs, size_t length) {
+  for (size_t i = 0; i != length; ++i) {  // simple enough for the auto-vectorizer
+    sums[i] += lhs[i];
+  }
+}
+
+inline void MinInPlace(uint32_t* result, const uint32_t* lhs, size_t length) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  for (; length - i >= 8; i += 8) {
+    const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(result + i));
+    const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), _mm256_min_epu32(a, b));
+  }
+#elif defined(__SSE4_1__)
+  for (; length - i >= 4; i += 4) {
+    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(result + i));
+    const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), _mm_min_epu32(a, b));
+  }
+#endif
+  for (; i != length; ++i) {
+    result[i] = (lhs[i] < result[i]) ? lhs[i] : result[i];
+  }
+}
+
+inline void MaxInPlace(uint32_t* result, const uint32_t* lhs, size_t length) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  for (; length - i >= 8; i += 8) {
+    const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(result + i));
+    const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), _mm256_max_epu32(a, b));
+  }
+#elif defined(__SSE4_1__)
+  for (; length - i >= 4; i += 4) {
+    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(result + i));
+    const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), _mm_max_epu32(a, b));
+  }
+#endif
+  for (; i != length; ++i) {
+    result[i] = (lhs[i] > result[i]) ? lhs[i] : result[i];
+  }
+}
+
+// smallest / largest of length > 0 numbers, branch-free so the compiler vectorizes it
+inline uint32_t Min(const uint32_t* lhs, size_t length) {
+  uint32_t result = lhs[0];
+  for (size_t i = 1; i != length; ++i) {
+    result = (lhs[i] < result) ? lhs[i] : result;
+  }
+
+  return result;
+}
+
+inline uint32_t Max(const uint32_t* lhs, size_t length) {
+  uint32_t result = lhs[0];
+  for (size_t i = 1; i != length; ++i) {
+    result = (lhs[i] > result) ? lhs[i] : result;
+  }
+
+  return result;
+}
+
+}  // namespace uint17::kernels
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "array.h"
+#include "array_iterator.h"
+#include "packing.h"
+#include "uint17_view.h"
+#include "utils.h"
+
+namespace uint17 {
+
+enum class MapMode { kReadOnly, kReadWrite };
+enum class AccessPattern { kNormal, kSequential, kRandom, kWillNeed };
+
+/*
+  Array whose packed bytes live in a memory mapping instead of the heap:
+  a file (read-only or shared read-write) or, for MappedArray(length), anonymous zero-filled memory.
+  Opening costs nothing, pages are read by the OS on first touch and shared with other processes
+  mapping the same file. Same element access and bulk Unpack / Pack as Array,
+  so ArrayView and ArrayWithVectorsView work on it unchanged.
+  Writing into a kReadOnly mapping is a segmentation fault, like writing into a const buffer.
+ */
+template <NumberView View = UInt17View>
+class MappedArray {
+  using Access = detail::PackedAccess<View>;
+
+ public:
+  using iterator = ArrayIterator<View, false>;
+  using const_iterator = ArrayIterator<View, true>;
+
+  explicit MappedArray(size_t length): length_(length), length_in_bytes_(BytesFor(length)) {
+    Map(-1, 0, MapMode::kReadWrite, "MappedArray::MappedArray");
+  }
+  /*
+    Maps length numbers stored at byte offset of an existing file, offset need not be page aligned.
+    The file must hold at least offset + ceil(length * kBitLength / 8) bytes
+   */
+  static MappedArray Open(const std::string& path, size_t length, MapMode mode = MapMode::kReadOnly, size_t offset = 0) {
+    const auto fd = ::open(path.c_str(), mode == MapMode::kReadOnly ? O_RDONLY : O_RDWR);
+    if (fd == -1) {
+      throw std::system_error(errno, std::generic_category(), "MappedArray::Open, " + path);
+    }
+    MappedArray result(fd, length, mode, offset, "MappedArray::Open");
+    ::close(fd);
+
+    return result;
+  }
+  // creates (or truncates) the file and maps it read-write, numbers start as zeros
+  static MappedArray Create(const std::string& path, size_t length) {
+    const auto fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+      throw std::system_error(errno, std::generic_category(), "MappedArray::Create, " + path);
+    }
+    if (::ftruncate(fd, static_cast<off_t>(BytesFor(length))) == -1) {
+      const auto error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), "MappedArray::Create, " + path);
+    }
+    MappedArray result(fd, length, MapMode::kReadWrite, 0, "MappedArray::Create");
+    ::close(fd);
+
+    return result;
+  }
+
+  MappedArray(MappedArray&& other)
+    : mapping_(other.mapping_), mapping_length_(other.mapping_length_), data_(other.data_),
+      length_(other.length_), length_in_bytes_(other.length_in_bytes_), mode_(other.mode_) {
+    other.mapping_ = nullptr;
+    other.mapping_length_ = 0;
+    other.data_ = nullptr;
+    other.length_ = 0;
+    other.length_in_bytes_ = 0;
+  }
+  MappedArray& operator=(MappedArray&& other) {
+    utils::Swap(mapping_, other.mapping_);
+    utils::Swap(mapping_length_, other.mapping_length_);
+    utils::Swap(data_, other.data_);
+    utils::Swap(length_, other.length_);
+    utils::Swap(length_in_bytes_, other.length_in_bytes_);
+    utils::Swap(mode_, other.mode_);
+
+    return *this;
+  }
+  MappedArray(const MappedArray&) = delete;
+  MappedArray& operator=(const MappedArray&) = delete;
+  ~MappedArray() {
+    if (mapping_ != nullptr) {
+      ::munmap(mapping_, mapping_length_);
+    }
+  }
+
+  // hint for the kernel's read-ahead, e.g. kSequential before a full pass, kRandom for scattered lookups
+  void Advise(AccessPattern pattern) const {
+    if (mapping_ == nullptr) {
+      return;
+    }
+    int advice = MADV_NORMAL;
+    switch (pattern) {
+      case AccessPattern::kNormal: advice = MADV_NORMAL; break;
+      case AccessPattern::kSequential: advice = MADV_SEQUENTIAL; break;
+      case AccessPattern::kRandom: advice = MADV_RANDOM; break;
+      case AccessPattern::kWillNeed: advice = MADV_WILLNEED; break;
+    }
+    if (::madvise(mapping_, mapping_length_, advice) == -1) {
+      throw std::system_error(errno, std::generic_category(), "MappedArray::Advise");
+    }
+  }
+  // writes dirty pages of a file mapping back to the file, blocks until done
+  void Sync() const {
+    if (mapping_ != nullptr && ::msync(mapping_, mapping_length_, MS_SYNC) == -1) {
+      throw std::system_error(errno, std::generic_category(), "MappedArray::Sync");
+    }
+  }
+
+  [[nodiscard]] size_t size() const { return length_; }
+  [[nodiscard]] size_t SizeInBytes() const { return length_in_bytes_; }
+  [[nodiscard]] bool IsWritable() const { return mode_ == MapMode::kReadWrite; }
+  [[nodiscard]] uint8_t* Data() { return data_; }
+  [[nodiscard]] const uint8_t* Data() const { return data_; }
+
+  iterator begin() { return {data_, 0}; }
+  iterator end() { return {data_, length_}; }
+  const_iterator begin() const { return {data_, 0}; }
+  const_iterator end() const { return {data_, length_}; }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  View operator[](size_t index) { return Access::Element(data_, index); }
+  const View operator[](size_t index) const { return Access::Element(data_, index); }
+  View At(size_t index) {
+    Access::CheckIndex(index, length_, "MappedArray::at");
+
+    return this->operator[](index);
+  }
+  const View At(size_t index) const {
+    Access::CheckIndex(index, length_, "MappedArray::at");
+
+    return this->operator[](index);
+  }
+  // same as Array::Unpack / Array::Pack
+  void Unpack(size_t begin, size_t count, uint32_t* out) const {
+    Access::CheckRange(begin, count, length_, "MappedArray::Unpack");
+    Access::Unpack(data_, begin, count, out);
+  }
+  void Pack(const uint32_t* in, size_t begin, size_t count) {
+    Access::CheckRange(begin, count, length_, "MappedArray::Pack");
+    Access::Pack(data_, in, begin, count);
+  }
+
+ private:
+  MappedArray(int fd, size_t length, MapMode mode, size_t offset, const char* where)
+    : length_(length), length_in_bytes_(BytesFor(length)) {
+    struct stat status{};
+    if (::fstat(fd, &status) == -1) {
+      const auto error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), where);
+    }
+    if (static_cast<size_t>(status.st_size) < offset || static_cast<size_t>(status.st_size) - offset < length_in_bytes_) {
+      ::close(fd);
+      throw std::out_of_range(std::string(where) + ", file is shorter than offset + length");
+    }
+    try {
+      Map(fd, offset, mode, where);
+    } catch (...) {
+      ::close(fd);
+      throw;
+    }
+  }
+
+  static size_t BytesFor(size_t length) { return Access::BytesFor(length); }
+
+  /*
+    mmap offsets must be page aligned, so the mapping starts at the page containing offset.
+    Element access reads up to packing::kTailSlack bytes past the last number, which may be past the end
+    of the file where pages are not readable, so address space for the slack is reserved
+    with an anonymous mapping and the file is mapped over its beginning
+   */
+  void Map(int fd, size_t offset, MapMode mode, const char* where) {
+    mode_ = mode;
+    if (length_in_bytes_ == 0) {  // mmap of zero bytes fails, an empty array needs no memory
+      return;
+    }
+    const auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const auto aligned_offset = offset / page * page;
+    const auto file_length = length_in_bytes_ + (offset - aligned_offset);
+    mapping_length_ = file_length + packing::kTailSlack;
+    const auto protection = (mode == MapMode::kReadOnly) ? PROT_READ : PROT_READ | PROT_WRITE;
+    auto* mapping = ::mmap(nullptr, mapping_length_, protection, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+      mapping_length_ = 0;
+      throw std::system_error(errno, std::generic_category(), where);
+    }
+    if (fd != -1 && ::mmap(mapping, file_length, protection, MAP_SHARED | MAP_FIXED, fd,
+                           static_cast<off_t>(aligned_offset)) == MAP_FAILED) {
+      const auto error = errno;
+      ::munmap(mapping, mapping_length_);
+      mapping_length_ = 0;
+      throw std::system_error(error, std::generic_category(), where);
+    }
+    mapping_ = mapping;
+    data_ = static_cast<uint8_t*>(mapping) + (offset - aligned_offset);
+  }
+
+  void* mapping_ = nullptr;
+  size_t mapping_length_ = 0;
+  uint8_t* data_ = nullptr;  // first byte of number 0, inside mapping_
+  size_t length_;
+  size_t length_in_bytes_;
+  MapMode mode_ = MapMode::kReadWrite;
+};
+
+}  // namespace uint17
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include "utils.h"
+
+namespace uint17::packing {
+
+/*
+  Numbers are stored as a big-endian bit stream: number i occupies bits [i * Bits, (i + 1) * Bits),
+  bit 0 being the most significant bit of the first byte (same layout as UIntNView).
+  8 numbers of Bits bits take exactly Bits bytes, so a group of 8 numbers always starts and ends on a byte boundary
+  and can be decoded with a couple of 64-bit loads instead of three byte loads per number.
+ */
+constexpr size_t kGroupLength = 8;
+
+template <size_t Bits>
+constexpr uint32_t kMask = (Bits == 32) ? ~uint32_t{0} : (uint32_t{1} << Bits) - 1;
+
+template <size_t Bits>
+constexpr size_t kGroupWords = (Bits + sizeof(uint64_t) - 1) / sizeof(uint64_t);  // 64-bit words covering a group
+
+template <size_t Bits>
+constexpr size_t kMinSpan = (Bits + CHAR_BIT - 1) / CHAR_BIT;  // bytes touched by a number starting at bit 0 of a byte
+template <size_t Bits>
+constexpr size_t kMaxSpan = (Bits + 2 * CHAR_BIT - 2) / CHAR_BIT;  // bytes touched by a number starting at bit 7
+
+/*
+  Reads go through whole words: a number is read with one unaligned 32-bit load (64-bit if Bits > 25)
+  from its first byte, a group with kGroupWords 64-bit loads. So buffers of packed numbers must be followed
+  by kTailSlack readable bytes. Writes never touch bytes outside the numbers written
+ */
+constexpr size_t kTailSlack = sizeof(uint64_t);
+
+template <size_t Bits>
+using Word = std::conditional_t<(Bits + CHAR_BIT - 1 <= 32), uint32_t, uint64_t>;  // covers a number at any offset
+
+template <size_t Bits>
+size_t Span(size_t offset) {
+  if constexpr (kMinSpan<Bits> == kMaxSpan<Bits>) {  // e.g. 17 bits always touch 3 bytes
+    return kMinSpan<Bits>;
+  } else {
+    return (offset + Bits + CHAR_BIT - 1) / CHAR_BIT;
+  }
+}
+
+template <size_t Bits>
+Word<Bits> LoadWord(const uint8_t* first) {
+  if constexpr (std::is_same_v<Word<Bits>, uint32_t>) {
+    return utils::LoadBigEndian32(first);
+  } else {
+    return utils::LoadBigEndian64(first);
+  }
+}
+
+// number of Bits bits starting at bit offset (0..7) of first
+template <size_t Bits>
+uint32_t ReadBits(const uint8_t* first, size_t offset) {
+  constexpr size_t kWordBits = sizeof(Word<Bits>) * CHAR_BIT;
+
+  return static_cast<uint32_t>(LoadWord<Bits>(first) >> (kWordBits - offset - Bits)) & kMask<Bits>;
+}
+
+// one word load, the modified word is stored back only into the Span bytes of the number
+template <size_t Bits>
+void WriteBits(uint8_t* first, size_t offset, uint32_t value) {
+  constexpr size_t kWordBits = sizeof(Word<Bits>) * CHAR_BIT;
+  const auto shift = kWordBits - offset - Bits;
+  auto word = LoadWord<Bits>(first);
+  word &= ~(static_cast<Word<Bits>>(kMask<Bits>) << shift);
+  word |= static_cast<Word<Bits>>(value & kMask<Bits>) << shift;
+  uint8_t bytes[sizeof(Word<Bits>)];
+  if constexpr (std::is_same_v<Word<Bits>, uint32_t>) {
+    utils::StoreBigEndian32(bytes, word);
+  } else {
+    utils::StoreBigEndian64(bytes, word);
+  }
+  if constexpr (kMinSpan<Bits> == kMaxSpan<Bits>) {  // constant sizes, so the copies become plain stores
+    std::memcpy(first, bytes, kMinSpan<Bits>);
+  } else if (Span<Bits>(offset) == kMinSpan<Bits>) {
+    std::memcpy(first, bytes, kMinSpan<Bits>);
+  } else {
+    std::memcpy(first, bytes, kMaxSpan<Bits>);
+  }
+}
+
+template <size_t Bits>
+uint32_t ReadValue(const uint8_t* data, size_t index) {
+  const auto start = index * Bits;
+
+  return ReadBits<Bits>(data + start / CHAR_BIT, start % CHAR_BIT);
+}
+
+template <size_t Bits>
+void WriteValue(uint8_t* data, size_t index, uint32_t value) {
+  const auto start = index * Bits;
+  WriteBits<Bits>(data + start / CHAR_BIT, start % CHAR_BIT, value);
+}
+
+template <size_t Bits>
+void UnpackGroup(const uint8_t* group, uint32_t* out) {
+  uint64_t words[kGroupWords<Bits>];  // the last word may reach into the next group or the tail slack
+  for (size_t i = 0; i != kGroupWords<Bits>; ++i) {
+    words[i] = utils::LoadBigEndian64(group + i * sizeof(uint64_t));
+  }
+
+  // every shift below is a compile-time constant, so the whole group unrolls into shifts and masks
+  [&]<size_t... K>(std::index_sequence<K...>) {
+    ((out[K] = [&] {
+      constexpr size_t kWord = K * Bits / 64;
+      constexpr size_t kShift = K * Bits % 64;
+      if constexpr (kShift + Bits <= 64) {
+        return static_cast<uint32_t>(words[kWord] >> (64 - kShift - Bits)) & kMask<Bits>;
+      } else {
+        return static_cast<uint32_t>((words[kWord] << (kShift + Bits - 64)) | (words[kWord + 1] >> (128 - kShift - Bits)))
+            & kMask<Bits>;
+      }
+    }()), ...);
+  }(std::make_index_sequence<kGroupLength>{});
+}
+
+template <size_t Bits>
+void PackGroup(const uint32_t* in, uint8_t* group) {
+  uint64_t words[kGroupWords<Bits>] = {};
+
+  [&]<size_t... K>(std::index_sequence<K...>) {
+    ([&] {
+      constexpr size_t kWord = K * Bits / 64;
+      constexpr size_t kShift = K * Bits % 64;
+      const uint64_t value = in[K] & kMask<Bits>;
+      if constexpr (kShift + Bits <= 64) {
+        words[kWord] |= value << (64 - kShift - Bits);
+      } else {
+        words[kWord] |= value >> (kShift + Bits - 64);
+        words[kWord + 1] |= value << (128 - kShift - Bits);
+      }
+    }(), ...);
+  }(std::make_index_sequence<kGroupLength>{});
+
+  uint8_t bytes[kGroupWords<Bits> * sizeof(uint64_t)];
+  for (size_t i = 0; i != kGroupWords<Bits>; ++i) {
+    utils::StoreBigEndian64(bytes + i * sizeof(uint64_t), words[i]);
+  }
+  std::memcpy(group, bytes, Bits);  // a group covers whole bytes, no read-modify-write needed
+}
+
+/*
+  Decodes numbers [begin, begin + count) into out.
+  Numbers before the first group boundary and after the last one are decoded one by one
+ */
+template <size_t Bits>
+void Unpack(const uint8_t* data, size_t begin, size_t count, uint32_t* out) {
+  const auto end = begin + count;
+  size_t i = begin;
+  for (; i != end && i % kGroupLength != 0; ++i) {
+    *out++ = ReadValue<Bits>(data, i);
+  }
+  for (; end - i >= kGroupLength; i += kGroupLength, out += kGroupLength) {
+    UnpackGroup<Bits>(data + i / kGroupLength * Bits, out);
+  }
+  for (; i != end; ++i) {
+    *out++ = ReadValue<Bits>(data, i);
+  }
+}
+
+/*
+  Encodes count numbers from in into positions [begin, begin + count), values are truncated to Bits bits.
+  Neighbouring numbers outside of the range are left untouched
+ */
+template <size_t Bits>
+void Pack(uint8_t* data, const uint32_t* in, size_t begin, size_t count) {
+  const auto end = begin + count;
+  size_t i = begin;
+  for (; i != end && i % kGroupLength != 0; ++i) {
+    WriteValue<Bits>(data, i, *in++);
+  }
+  for (; end - i >= kGroupLength; i += kGroupLength, in += kGroupLength) {
+    PackGroup<Bits>(in, data + i / kGroupLength * Bits);
+  }
+  for (; i != end; ++i) {
+    WriteValue<Bits>(data, i, *in++);
+  }
+}
+
+}  // namespace uint17::packing
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include "array_view.h"
+#include "expression.h"
+#include "kernels.h"
+#include "packing.h"
+#include "thread_pool.h"
+
+/*
+  Multithreaded fills and copies of views. Like the parallel evaluation of expressions
+  ((a + b * 3u).EvaluateInto(destination, pool), see expression.h) the destination is split
+  on kWriteAlignment<Container> boundaries, so threads never share a byte of a packed container
+ */
+namespace uint17::parallel {
+
+template <size_t Dimension, RandomAccessContainer Container>
+void Fill(const ArrayView<Dimension, Container>& view, uint32_t value, ThreadPool& pool = ThreadPool::Default()) {
+  auto& container = view.GetContainer();
+  const auto start = view.GetStart();
+  PrepareForWrite(container);
+  ParallelForRange(pool, start, view.GetLength(), kWriteAlignment<Container>, expression::kParallelMinPiece,
+                   [&](size_t begin, size_t end) {
+    uint32_t lanes[kernels::kBlockLength];
+    for (auto& lane : lanes) {
+      lane = value;
+    }
+    for (size_t i = begin; i < end; i += kernels::kBlockLength) {
+      const auto block = (end - i < kernels::kBlockLength) ? end - i : kernels::kBlockLength;
+      expression::StoreRange(container, start + i, block, lanes);
+    }
+  });
+}
+
+// destination and source must have the same dimensions and must not overlap
+template <size_t Dimension, RandomAccessContainer Destination, RandomAccessContainer Source>
+void Copy(const ArrayView<Dimension, Destination>& destination, const ArrayView<Dimension, Source>& source,
+          ThreadPool& pool = ThreadPool::Default()) {
+  for (size_t i = 0; i != Dimension; ++i) {
+    if (destination.GetDimension(i) != source.GetDimension(i)) {
+      throw std::logic_error("parallel::Copy different dimensions used");
+    }
+  }
+  auto& to = destination.GetContainer();
+  const auto& from = source.GetContainer();
+  const auto to_start = destination.GetStart();
+  const auto from_start = source.GetStart();
+  PrepareForWrite(to);
+  ParallelForRange(pool, to_start, destination.GetLength(), kWriteAlignment<Destination>, expression::kParallelMinPiece,
+                   [&](size_t begin, size_t end) {
+    uint32_t lanes[kernels::kBlockLength];
+    for (size_t i = begin; i < end; i += kernels::kBlockLength) {
+      const auto block = (end - i < kernels::kBlockLength) ? end - i : kernels::kBlockLength;
+      expression::LoadRange(from, from_start + i, block, lanes);
+      expression::StoreRange(to, to_start + i, block, lanes);
+    }
+  });
+}
+
+}  // namespace uint17::parallel
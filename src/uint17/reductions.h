@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "array_view.h"
+#include "expression.h"
+#include "kernels.h"
+
+/*
+  Reductions of views: numbers are decoded block by block through Unpack (see expression::LoadRange)
+  and reduced by the kernels of kernels.h, no per-number proxy or bounds check is involved.
+  Positions are row-major indices inside the view. Reductions along an axis drop that axis:
+  for a view of dimensions (d0, d1, d2) and axis 1 the result has dimensions (d0, d2).
+ */
+namespace uint17 {
+
+struct Extremum {
+  uint32_t value;
+  size_t position;  // row-major index of the first occurrence in the view
+};
+
+namespace detail {
+
+// calls function(lanes, offset, length) for consecutive blocks of numbers [begin, begin + length) of container
+template <typename Container, typename Function>
+void ForEachBlock(const Container& container, size_t begin, size_t length, Function&& function) {
+  uint32_t lanes[kernels::kBlockLength];
+  for (size_t i = 0; i < length; i += kernels::kBlockLength) {
+    const auto block = (length - i < kernels::kBlockLength) ? length - i : kernels::kBlockLength;
+    expression::LoadRange(container, begin + i, block, lanes);
+    function(static_cast<const uint32_t*>(lanes), i, block);
+  }
+}
+
+template <typename Container>
+uint64_t SumRange(const Container& container, size_t begin, size_t length) {
+  uint64_t result = 0;
+  ForEachBlock(container, begin, length, [&](const uint32_t* lanes, size_t, size_t block) {
+    result += kernels::Sum(lanes, block);
+  });
+
+  return result;
+}
+
+template <bool IsMin, typename Container>
+Extremum ExtremumRange(const Container& container, size_t begin, size_t length) {
+  Extremum result{0, 0};
+  ForEachBlock(container, begin, length, [&](const uint32_t* lanes, size_t offset, size_t block) {
+    const auto value = IsMin ? kernels::Min(lanes, block) : kernels::Max(lanes, block);
+    if (offset == 0 || (IsMin ? value < result.value : value > result.value)) {
+      size_t k = 0;
+      while (lanes[k] != value) {  // rescanning one block only happens when it improves the extremum
+        ++k;
+      }
+      result = {value, offset + k};
+    }
+  });
+
+  return result;
+}
+
+// sizes of the axes before the axis, of the axis and after it, the view is outer x axis x inner
+template <typename View>
+void SplitAtAxis(const View& view, size_t dimension, size_t axis, size_t& outer, size_t& inner) {
+  if (axis >= dimension) {
+    throw std::out_of_range("Reduction along a missing axis");
+  }
+  outer = 1;
+  inner = 1;
+  for (size_t i = 0; i != axis; ++i) {
+    outer *= view.GetDimension(i);
+  }
+  for (size_t i = axis + 1; i != dimension; ++i) {
+    inner *= view.GetDimension(i);
+  }
+}
+
+template <bool IsMin, size_t Dimension, RandomAccessContainer Container>
+ViewWithContainer<Dimension - 1, Container> ExtremumAlongAxis(const ArrayView<Dimension, Container>& view, size_t axis) {
+  size_t outer, inner;
+  SplitAtAxis(view, Dimension, axis, outer, inner);
+  const auto length = view.GetDimension(axis);
+  if (length == 0) {
+    throw std::invalid_argument(IsMin ? "MinAlongAxis of an empty axis" : "MaxAlongAxis of an empty axis");
+  }
+  size_t dimensions[Dimension - 1];
+  for (size_t i = 0, j = 0; i != Dimension; ++i) {
+    if (i != axis) {
+      dimensions[j++] = view.GetDimension(i);
+    }
+  }
+  auto* container = new Container(outer * inner);
+  ArrayView<Dimension - 1, Container> result(*container, 0, dimensions);
+
+  const auto& source = view.GetContainer();
+  std::vector<uint32_t> row(inner);
+  for (size_t o = 0; o != outer; ++o) {
+    const auto row_start = view.GetStart() + o * length * inner;
+    if (inner == 1) {  // reducing the last axis: one contiguous range per result number
+      row[0] = ExtremumRange<IsMin>(source, row_start, length).value;
+    } else {
+      expression::LoadRange(source, row_start, inner, row.data());
+      for (size_t k = 1; k != length; ++k) {
+        ForEachBlock(source, row_start + k * inner, inner, [&](const uint32_t* lanes, size_t offset, size_t block) {
+          if constexpr (IsMin) {
+            kernels::MinInPlace(row.data() + offset, lanes, block);
+          } else {
+            kernels::MaxInPlace(row.data() + offset, lanes, block);
+          }
+        });
+      }
+    }
+    expression::StoreRange(*container, o * inner, inner, row.data());
+  }
+
+  return {result, container};
+}
+
+}  // namespace detail
+
+template <size_t Dimension, RandomAccessContainer Container>
+uint64_t Sum(const ArrayView<Dimension, Container>& view) {
+  return detail::SumRange(view.GetContainer(), view.GetStart(), view.GetLength());
+}
+
+template <size_t Dimension, RandomAccessContainer Container>
+Extremum Min(const ArrayView<Dimension, Container>& view) {
+  if (view.GetLength() == 0) {
+    throw std::invalid_argument("Min of an empty view");
+  }
+
+  return detail::ExtremumRange<true>(view.GetContainer(), view.GetStart(), view.GetLength());
+}
+
+template <size_t Dimension, RandomAccessContainer Container>
+Extremum Max(const ArrayView<Dimension, Container>& view) {
+  if (view.GetLength() == 0) {
+    throw std::invalid_argument("Max of an empty view");
+  }
+
+  return detail::ExtremumRange<false>(view.GetContainer(), view.GetStart(), view.GetLength());
+}
+
+template <size_t Dimension, RandomAccessContainer Lhs, RandomAccessContainer Rhs>
+uint64_t Dot(const ArrayView<Dimension, Lhs>& lhs, const ArrayView<Dimension, Rhs>& rhs) {
+  for (size_t i = 0; i != Dimension; ++i) {
+    if (lhs.GetDimension(i) != rhs.GetDimension(i)) {
+      throw std::logic_error("Dot different dimensions used");
+    }
+  }
+  uint64_t result = 0;
+  uint32_t rhs_lanes[kernels::kBlockLength];
+  detail::ForEachBlock(lhs.GetContainer(), lhs.GetStart(), lhs.GetLength(),
+                       [&](const uint32_t* lanes, size_t offset, size_t block) {
+    expression::LoadRange(rhs.GetContainer(), rhs.GetStart() + offset, block, rhs_lanes);
+    result += kernels::Dot(lanes, rhs_lanes, block);
+  });
+
+  return result;
+}
+
+// counts of every value 0 .. 2^kBitLength - 1 of the numbers (2^17 buckets for UInt17View)
+template <size_t Dimension, RandomAccessContainer Container>
+std::vector<uint64_t> Histogram(const ArrayView<Dimension, Container>& view) {
+  using Element = std::remove_cvref_t<decltype(view.GetContainer()[size_t{}])>;
+  static_assert(Element::kBitLength <= 24, "Histogram of numbers wider than 24 bits needs too many buckets");
+  std::vector<uint64_t> buckets(size_t{1} << Element::kBitLength);
+  detail::ForEachBlock(view.GetContainer(), view.GetStart(), view.GetLength(),
+                       [&](const uint32_t* lanes, size_t, size_t block) {
+    for (size_t i = 0; i != block; ++i) {
+      ++buckets[lanes[i]];
+    }
+  });
+
+  return buckets;
+}
+
+/*
+  Sums along axis, row-major over the remaining axes. Sums of many numbers do not fit into kBitLength bits,
+  so unlike MinAlongAxis / MaxAlongAxis the result is a vector of 64-bit sums rather than an array
+ */
+template <size_t Dimension, RandomAccessContainer Container>
+std::vector<uint64_t> SumAlongAxis(const ArrayView<Dimension, Container>& view, size_t axis) requires (Dimension > 1) {
+  size_t outer, inner;
+  detail::SplitAtAxis(view, Dimension, axis, outer, inner);
+  const auto length = view.GetDimension(axis);
+  const auto& source = view.GetContainer();
+  std::vector<uint64_t> result(outer * inner);
+  for (size_t o = 0; o != outer; ++o) {
+    const auto row_start = view.GetStart() + o * length * inner;
+    if (inner == 1) {
+      result[o] = detail::SumRange(source, row_start, length);
+      continue;
+    }
+    for (size_t k = 0; k != length; ++k) {  // adding whole rows keeps the inner loop contiguous
+      detail::ForEachBlock(source, row_start + k * inner, inner, [&](const uint32_t* lanes, size_t offset, size_t block) {
+        kernels::Accumulate(result.data() + o * inner + offset, lanes, block);
+      });
+    }
+  }
+
+  return result;
+}
+
+// lower-rank array of the smallest / largest numbers along axis, the caller owns the container as with MakeArray
+template <size_t Dimension, RandomAccessContainer Container>
+ViewWithContainer<Dimension - 1, Container> MinAlongAxis(const ArrayView<Dimension, Container>& view, size_t axis)
+  requires (Dimension > 1) {
+  return detail::ExtremumAlongAxis<true>(view, axis);
+}
+
+template <size_t Dimension, RandomAccessContainer Container>
+ViewWithContainer<Dimension - 1, Container> MaxAlongAxis(const ArrayView<Dimension, Container>& view, size_t axis)
+  requires (Dimension > 1) {
+  return detail::ExtremumAlongAxis<false>(view, axis);
+}
+
+}  // namespace uint17
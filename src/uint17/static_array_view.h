@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include "array_view.h"
+#include "array_with_vectors_view.h"
+
+namespace uint17 {
+
+/*
+  ArrayView with dimensions known at compile time: StaticArrayView<Array<>, 512, 512, 512>.
+  Strides are constants, so v[i][j][k] and v(i, j, k) compile to multiplications by constants,
+  and the view stores nothing but the container and the start
+ */
+template <RandomAccessContainer Container, size_t First, size_t... Rest> requires ((First > 0) && ((Rest > 0) && ...))
+class StaticArrayView {
+ public:
+  static constexpr size_t kDimension = 1 + sizeof...(Rest);
+  static constexpr size_t kLength = (First * ... * Rest);
+  static constexpr std::array<size_t, kDimension> kDimensions = {First, Rest...};
+  static constexpr std::array<size_t, kDimension> kStrides = [] {
+    std::array<size_t, kDimension> strides{};
+    size_t stride = 1;
+    for (size_t i = kDimension; i != 0; --i) {
+      strides[i - 1] = stride;
+      stride *= kDimensions[i - 1];
+    }
+
+    return strides;
+  }();
+
+  explicit StaticArrayView(Container& container, size_t start = 0): container_(&container), start_(start) {
+    if (start_ + kLength > container.size()) {
+      throw std::out_of_range("StaticArrayView::StaticArrayView, view with given dimensions end after container end");
+    }
+  }
+
+  decltype(auto) operator[](size_t index) {
+    if (index >= First) {
+      throw std::out_of_range("StaticArrayView::operator[]");
+    }
+    if constexpr (kDimension == 1) {
+      return (*container_)[start_ + index];
+    } else {
+      return StaticArrayView<Container, Rest...>(*container_, start_ + index * kStrides[0], detail::Unchecked{});
+    }
+  }
+  decltype(auto) operator[](size_t index) const {
+    if (index >= First) {
+      throw std::out_of_range("StaticArrayView::operator[]");
+    }
+    if constexpr (kDimension == 1) {
+      return static_cast<const Container&>(*container_)[start_ + index];
+    } else {
+      return StaticArrayView<Container, Rest...>(*container_, start_ + index * kStrides[0], detail::Unchecked{});
+    }
+  }
+
+  // unchecked access to element (indices...), one dot product with constant strides
+  template <typename... Args> requires Dimensions<kDimension, Args...>
+  decltype(auto) operator()(Args... indices) {
+    return (*container_)[Offset(indices...)];
+  }
+  template <typename... Args> requires Dimensions<kDimension, Args...>
+  decltype(auto) operator()(Args... indices) const {
+    return static_cast<const Container&>(*container_)[Offset(indices...)];
+  }
+
+  [[nodiscard]] static constexpr size_t GetDimension(size_t index) { return kDimensions[index]; }
+  [[nodiscard]] static constexpr size_t GetStride(size_t index) { return kStrides[index]; }
+  [[nodiscard]] static constexpr size_t GetLength() { return kLength; }
+  [[nodiscard]] size_t GetStart() const { return start_; }
+  [[nodiscard]] Container& GetContainer() const { return *container_; }
+
+  auto begin() { return detail::IteratorAt(*container_, start_); }
+  auto end() { return detail::IteratorAt(*container_, start_ + kLength); }
+  auto begin() const { return detail::IteratorAt(static_cast<const Container&>(*container_), start_); }
+  auto end() const { return detail::IteratorAt(static_cast<const Container&>(*container_), start_ + kLength); }
+
+  [[nodiscard]] ArrayView<kDimension, Container> ToView() const {
+    return ArrayView<kDimension, Container>(*container_, start_, kDimensions.data());
+  }
+  [[nodiscard]] ArrayWithVectorsView<kDimension, Container> ToVectorsView() const
+    requires RandomAccessContainerWithVectors<Container> {
+    return ArrayWithVectorsView<kDimension, Container>(*container_, start_, kDimensions.data());
+  }
+
+  template <typename Node>
+  StaticArrayView& operator=(const VectorsExpression<kDimension, Container, Node>& expression) {
+    expression.EvaluateInto(ToVectorsView());
+
+    return *this;
+  }
+
+ private:
+  template <RandomAccessContainer, size_t OtherFirst, size_t... OtherRest> requires ((OtherFirst > 0) && ((OtherRest > 0) && ...))
+  friend class StaticArrayView;
+
+  StaticArrayView(Container& container, size_t start, detail::Unchecked): container_(&container), start_(start) {}
+
+  template <typename... Args>
+  size_t Offset(Args... indices) const {
+    size_t offset = start_;
+    size_t axis = 0;
+    ((offset += static_cast<size_t>(indices) * kStrides[axis++]), ...);
+
+    return offset;
+  }
+
+  Container* container_;
+  size_t start_;
+};
+
+template <RandomAccessContainerWithVectors Container, size_t First, size_t... Rest>
+struct VectorsOperandTraits<StaticArrayView<Container, First, Rest...>> {
+  static constexpr bool kIsOperand = true;
+  static constexpr size_t kDimension = 1 + sizeof...(Rest);
+  using ContainerType = Container;
+
+  static expression::Leaf<kDimension, Container> ToNode(const StaticArrayView<Container, First, Rest...>& view) {
+    return {view.GetContainer(), view.GetStart(), StaticArrayView<Container, First, Rest...>::kDimensions.data()};
+  }
+};
+
+}  // namespace uint17
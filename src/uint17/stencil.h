@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "array_view.h"
+#include "expression.h"
+#include "kernels.h"
+
+/*
+  3D stencils over row-major views: output(i, j, k) = sum of weight(di, dj, dk) * input(i + di, j + dj, k + dk)
+  over the 27 neighbours (di, dj, dk in -1, 0, 1), divided by the divisor.
+  Every plane of the input is decoded once into a window of decoded planes whose rows have a one number halo,
+  a row of the output is a few kernels::MultiplyAdd over shifted rows of the window, then packed with Pack.
+  Sums are computed modulo 2^32 and divided as signed 32-bit numbers, so negative weights (Laplacian) work,
+  the result is stored modulo 2^kBitLength like the results of view arithmetic.
+
+    ApplyStencil(volume, smoothed, Stencil::TwentySevenPoint(1, 1, 1, 1, 27), Boundary::kClamp);
+ */
+namespace uint17 {
+
+// value of neighbours outside the volume: the nearest number, zero or the number from the opposite side
+enum class Boundary { kClamp, kZero, kWrap };
+
+struct Stencil {
+  int32_t weights[3][3][3] = {};  // weights[di + 1][dj + 1][dk + 1]
+  int32_t divisor = 1;
+
+  // center and the 6 neighbours sharing a face, e.g. SevenPoint(-6, 1) is the discrete Laplacian
+  static Stencil SevenPoint(int32_t center, int32_t face, int32_t divisor = 1) {
+    return TwentySevenPoint(center, face, 0, 0, divisor);
+  }
+  // weights by the number of nonzero offsets: 0 center, 1 faces, 2 edges, 3 corners
+  static Stencil TwentySevenPoint(int32_t center, int32_t face, int32_t edge, int32_t corner, int32_t divisor = 1) {
+    if (divisor == 0) {
+      throw std::invalid_argument("Stencil divisor is zero");
+    }
+    const int32_t by_distance[] = {center, face, edge, corner};
+    Stencil result;
+    result.divisor = divisor;
+    for (size_t di = 0; di != 3; ++di) {
+      for (size_t dj = 0; dj != 3; ++dj) {
+        for (size_t dk = 0; dk != 3; ++dk) {
+          result.weights[di][dj][dk] = by_distance[(di != 1) + (dj != 1) + (dk != 1)];
+        }
+      }
+    }
+
+    return result;
+  }
+};
+
+namespace detail {
+
+constexpr size_t kOutside = SIZE_MAX;
+
+// index + offset on an axis of length, kOutside if the neighbour is zero
+inline size_t NeighbourIndex(size_t index, int offset, size_t length, Boundary boundary) {
+  if (offset < 0 && index == 0) {
+    return (boundary == Boundary::kClamp) ? 0 : (boundary == Boundary::kWrap) ? length - 1 : kOutside;
+  }
+  if (offset > 0 && index + 1 == length) {
+    return (boundary == Boundary::kClamp) ? index : (boundary == Boundary::kWrap) ? 0 : kOutside;
+  }
+
+  return static_cast<size_t>(static_cast<std::ptrdiff_t>(index) + offset);
+}
+
+/*
+  Decoded planes of the input, each row is stored as halo, d2 numbers, halo.
+  Holds the three planes around the current one plus plane 0, which kWrap needs again at the last plane
+  after the output may already have overwritten it
+ */
+template <typename Container>
+class PlaneWindow {
+ public:
+  static constexpr size_t kSlots = 4;
+
+  PlaneWindow(const ArrayView<3, Container>& view, Boundary boundary)
+    : view_(view), boundary_(boundary), row_length_(view.GetDimension(2) + 2),
+      plane_length_(view.GetDimension(1) * row_length_), buffer_(kSlots * plane_length_) {
+    for (auto& index : indices_) {
+      index = kOutside;
+    }
+  }
+
+  // decoded plane, decodes it into a slot not used by the planes around current if needed
+  const uint32_t* Get(size_t plane, size_t current) {
+    for (size_t slot = 0; slot != kSlots; ++slot) {
+      if (indices_[slot] == plane) {
+        return buffer_.data() + slot * plane_length_;
+      }
+    }
+    const auto length = view_.GetDimension(0);
+    size_t slot = 0;
+    while (indices_[slot] != kOutside && (indices_[slot] == 0 || IsAround(indices_[slot], current, length))) {
+      ++slot;
+    }
+    indices_[slot] = plane;
+    auto* rows = buffer_.data() + slot * plane_length_;
+    Decode(plane, rows);
+
+    return rows;
+  }
+
+  [[nodiscard]] size_t GetRowLength() const { return row_length_; }
+
+ private:
+  bool IsAround(size_t plane, size_t current, size_t length) const {
+    for (int offset = -1; offset <= 1; ++offset) {
+      if (NeighbourIndex(current, offset, length, boundary_) == plane) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void Decode(size_t plane, uint32_t* rows) const {
+    const auto length = view_.GetDimension(2);
+    for (size_t j = 0; j != view_.GetDimension(1); ++j) {
+      auto* row = rows + j * row_length_;
+      expression::LoadRange(view_.GetContainer(), view_.GetStart() + plane * view_.GetStride(0) + j * view_.GetStride(1),
+                            length, row + 1);
+      switch (boundary_) {
+        case Boundary::kClamp: row[0] = row[1]; row[length + 1] = row[length]; break;
+        case Boundary::kZero: row[0] = 0; row[length + 1] = 0; break;
+        case Boundary::kWrap: row[0] = row[length]; row[length + 1] = row[1]; break;
+      }
+    }
+  }
+
+  const ArrayView<3, Container>& view_;
+  Boundary boundary_;
+  size_t row_length_;
+  size_t plane_length_;
+  std::vector<uint32_t> buffer_;
+  size_t indices_[kSlots];  // plane decoded in each slot, kOutside for a free slot
+};
+
+}  // namespace detail
+
+/*
+  Applies stencil to input and writes the result to output of the same dimensions.
+  Output may be the input view itself: every input plane is decoded before the output planes depending on it are written
+ */
+template <RandomAccessContainer In, RandomAccessContainer Out>
+void ApplyStencil(const ArrayView<3, In>& input, const ArrayView<3, Out>& output, const Stencil& stencil,
+                  Boundary boundary = Boundary::kClamp) {
+  for (size_t axis = 0; axis != 3; ++axis) {
+    if (input.GetDimension(axis) != output.GetDimension(axis)) {
+      throw std::logic_error("ApplyStencil different dimensions used");
+    }
+  }
+  if (stencil.divisor == 0) {
+    throw std::invalid_argument("Stencil divisor is zero");
+  }
+  const size_t dimensions[] = {input.GetDimension(0), input.GetDimension(1), input.GetDimension(2)};
+  if (dimensions[0] == 0 || dimensions[1] == 0 || dimensions[2] == 0) {
+    return;
+  }
+  detail::PlaneWindow<In> window(input, boundary);
+  std::vector<uint32_t> sums(dimensions[2]);
+  const uint32_t* planes[3];
+  for (size_t i = 0; i != dimensions[0]; ++i) {
+    for (int di = -1; di <= 1; ++di) {  // all three planes are decoded before plane i of output is written
+      const auto plane = detail::NeighbourIndex(i, di, dimensions[0], boundary);
+      planes[di + 1] = (plane == detail::kOutside) ? nullptr : window.Get(plane, i);
+    }
+    for (size_t j = 0; j != dimensions[1]; ++j) {
+      std::fill(sums.begin(), sums.end(), 0u);
+      for (int di = -1; di <= 1; ++di) {
+        if (planes[di + 1] == nullptr) {
+          continue;
+        }
+        for (int dj = -1; dj <= 1; ++dj) {
+          const auto row_index = detail::NeighbourIndex(j, dj, dimensions[1], boundary);
+          if (row_index == detail::kOutside) {
+            continue;
+          }
+          const auto* row = planes[di + 1] + row_index * window.GetRowLength();
+          for (int dk = -1; dk <= 1; ++dk) {
+            const auto weight = stencil.weights[di + 1][dj + 1][dk + 1];
+            if (weight != 0) {  // row + 1 + dk is the row shifted by dk, the halo supplies the border neighbours
+              kernels::MultiplyAdd(sums.data(), row + 1 + dk, static_cast<uint32_t>(weight), dimensions[2]);
+            }
+          }
+        }
+      }
+      if (stencil.divisor != 1) {
+        kernels::DivideSigned(sums.data(), stencil.divisor, dimensions[2]);
+      }
+      expression::StoreRange(output.GetContainer(), output.GetStart() + i * output.GetStride(0) + j * output.GetStride(1),
+                             dimensions[2], sums.data());
+    }
+  }
+}
+
+}  // namespace uint17
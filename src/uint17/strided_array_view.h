@@ -0,0 +1,265 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include "array_view.h"
+
+namespace uint17 {
+
+/*
+  View of numbers at start + i0 * strides[0] + ... + in * strides[n] of a container.
+  Strides may be arbitrary (and negative), so sub-boxes, every k-th number, reversed axes,
+  transposed volumes and planes across any axis are all views of the same memory, nothing is copied:
+
+    StridedArrayView<3> volume(view);                    // from a contiguous ArrayView<3>
+    auto plane = volume.Fix(1, 10);                      // StridedArrayView<2>, y == 10
+    auto box = volume.Slice(0, 2, 10).Slice(2, 0, 64, 2);
+    auto transposed = volume.Transpose();
+ */
+template <size_t Dimension, RandomAccessContainer Container = Array<UInt17View>>
+class StridedArrayView {
+ public:
+  // throws std::out_of_range if the lowest or the highest offset the view reaches is outside the container
+  StridedArrayView(Container& container, size_t start, const size_t* dimensions, const std::ptrdiff_t* strides)
+    : StridedArrayView(container, start, dimensions, strides, detail::Unchecked{}) {
+    if (GetLength() != 0 && !IsInside(container.size())) {
+      throw std::out_of_range("StridedArrayView::StridedArrayView, view with given dimensions and strides "
+                              "reaches outside the container");
+    }
+  }
+  StridedArrayView(Container& container, size_t start, const size_t* dimensions, const std::ptrdiff_t* strides,
+                   detail::Unchecked)
+    : container_(&container), start_(start) {
+    for (size_t i = 0; i != Dimension; ++i) {
+      dimensions_[i] = dimensions[i];
+      strides_[i] = strides[i];
+    }
+  }
+  template <typename View> requires requires(const View& view) {
+    { view.GetContainer() } -> std::same_as<Container&>;
+    view.GetStride(size_t{});
+    view.GetDimension(size_t{});
+  }
+  explicit StridedArrayView(const View& view): container_(&view.GetContainer()), start_(view.GetStart()) {
+    for (size_t i = 0; i != Dimension; ++i) {
+      dimensions_[i] = view.GetDimension(i);
+      strides_[i] = static_cast<std::ptrdiff_t>(view.GetStride(i));
+    }
+  }
+
+  decltype(auto) operator[](size_t index) {
+    if (index >= dimensions_[0]) {
+      throw std::out_of_range("StridedArrayView::operator[]");
+    }
+    if constexpr (Dimension == 1) {
+      return (*container_)[Offset(index)];
+    } else {
+      return Fix(0, index);
+    }
+  }
+  decltype(auto) operator[](size_t index) const {
+    if (index >= dimensions_[0]) {
+      throw std::out_of_range("StridedArrayView::operator[]");
+    }
+    if constexpr (Dimension == 1) {
+      return static_cast<const Container&>(*container_)[Offset(index)];
+    } else {
+      return Fix(0, index);
+    }
+  }
+
+  // unchecked access to element (indices...)
+  template <typename... Args> requires Dimensions<Dimension, Args...>
+  decltype(auto) operator()(Args... indices) {
+    return (*container_)[Offset(indices...)];
+  }
+  template <typename... Args> requires Dimensions<Dimension, Args...>
+  decltype(auto) operator()(Args... indices) const {
+    return static_cast<const Container&>(*container_)[Offset(indices...)];
+  }
+
+  /*
+    Numbers begin, begin + step, ... along axis, stopping before end (Python's begin:end:step).
+    For a negative step begin > end, end == -1 means "down to index 0 inclusive"
+   */
+  StridedArrayView Slice(size_t axis, std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t step = 1) const {
+    if (axis >= Dimension) {
+      throw std::out_of_range("StridedArrayView::Slice, axis");
+    }
+    if (step == 0) {
+      throw std::invalid_argument("StridedArrayView::Slice, zero step");
+    }
+    const auto dimension = static_cast<std::ptrdiff_t>(dimensions_[axis]);
+    size_t length;
+    if (step > 0) {
+      if (begin < 0 || end < begin || end > dimension) {
+        throw std::out_of_range("StridedArrayView::Slice");
+      }
+      length = static_cast<size_t>((end - begin + step - 1) / step);
+    } else {
+      if (end < -1 || begin < end || begin >= dimension) {
+        throw std::out_of_range("StridedArrayView::Slice");
+      }
+      length = static_cast<size_t>((begin - end - step - 1) / -step);
+    }
+    StridedArrayView result(*this);
+    if (length != 0) {
+      result.start_ = static_cast<size_t>(static_cast<std::ptrdiff_t>(start_) + begin * strides_[axis]);
+    }
+    result.dimensions_[axis] = length;
+    result.strides_[axis] *= step;
+
+    return result;
+  }
+  StridedArrayView Reverse(size_t axis) const {
+    if (axis >= Dimension) {
+      throw std::out_of_range("StridedArrayView::Reverse, axis");
+    }
+
+    return Slice(axis, static_cast<std::ptrdiff_t>(dimensions_[axis]) - 1, -1, -1);
+  }
+  // axis i of the result is axis axes[i] of this view
+  StridedArrayView Permute(const size_t* axes) const {
+    bool used[Dimension] = {};
+    StridedArrayView result(*this);
+    for (size_t i = 0; i != Dimension; ++i) {
+      if (axes[i] >= Dimension || used[axes[i]]) {
+        throw std::invalid_argument("StridedArrayView::Permute, axes are not a permutation");
+      }
+      used[axes[i]] = true;
+      result.dimensions_[i] = dimensions_[axes[i]];
+      result.strides_[i] = strides_[axes[i]];
+    }
+
+    return result;
+  }
+  StridedArrayView Transpose() const {  // reverses the order of axes
+    size_t axes[Dimension];
+    for (size_t i = 0; i != Dimension; ++i) {
+      axes[i] = Dimension - 1 - i;
+    }
+
+    return Permute(axes);
+  }
+  // plane (or line) where axis is fixed to index
+  StridedArrayView<Dimension - 1, Container> Fix(size_t axis, size_t index) const requires (Dimension > 1) {
+    if (axis >= Dimension || index >= dimensions_[axis]) {
+      throw std::out_of_range("StridedArrayView::Fix");
+    }
+    size_t dimensions[Dimension - 1];
+    std::ptrdiff_t strides[Dimension - 1];
+    for (size_t i = 0, j = 0; i != Dimension; ++i) {
+      if (i != axis) {
+        dimensions[j] = dimensions_[i];
+        strides[j] = strides_[i];
+        ++j;
+      }
+    }
+    const auto start = static_cast<std::ptrdiff_t>(start_) + static_cast<std::ptrdiff_t>(index) * strides_[axis];
+
+    return StridedArrayView<Dimension - 1, Container>(*container_, static_cast<size_t>(start), dimensions, strides,
+                                                      detail::Unchecked{});
+  }
+
+  // calls function(element) for every element in row-major order of this view
+  template <typename Function>
+  void ForEach(Function&& function) const {
+    if (GetLength() == 0) {
+      return;
+    }
+    size_t index[Dimension] = {};
+    auto offset = static_cast<std::ptrdiff_t>(start_);
+    const auto inner = Dimension - 1;
+    while (true) {
+      auto element = offset;
+      for (size_t k = 0; k != dimensions_[inner]; ++k, element += strides_[inner]) {
+        function((*container_)[static_cast<size_t>(element)]);
+      }
+      size_t axis = inner;
+      while (true) {  // odometer increment of the outer indices
+        if (axis == 0) {
+          return;
+        }
+        --axis;
+        offset += strides_[axis];
+        if (++index[axis] != dimensions_[axis]) {
+          break;
+        }
+        offset -= strides_[axis] * static_cast<std::ptrdiff_t>(dimensions_[axis]);
+        index[axis] = 0;
+      }
+    }
+  }
+
+  [[nodiscard]] size_t GetDimension(size_t index) const { return dimensions_[index]; }
+  [[nodiscard]] std::ptrdiff_t GetStride(size_t index) const { return strides_[index]; }
+  [[nodiscard]] size_t GetStart() const { return start_; }
+  [[nodiscard]] Container& GetContainer() const { return *container_; }
+  [[nodiscard]] size_t GetLength() const {
+    size_t length = 1;
+    for (size_t i = 0; i != Dimension; ++i) {
+      length *= dimensions_[i];
+    }
+
+    return length;
+  }
+  // true if the view is a plain row-major block, i.e. may be turned back into an ArrayView
+  [[nodiscard]] bool IsContiguous() const {
+    std::ptrdiff_t stride = 1;
+    for (size_t i = Dimension; i != 0; --i) {
+      if (dimensions_[i - 1] != 1 && strides_[i - 1] != stride) {
+        return false;
+      }
+      stride *= static_cast<std::ptrdiff_t>(dimensions_[i - 1]);
+    }
+
+    return true;
+  }
+
+ private:
+  template <typename... Args>
+  size_t Offset(Args... indices) const {
+    auto offset = static_cast<std::ptrdiff_t>(start_);
+    size_t axis = 0;
+    ((offset += static_cast<std::ptrdiff_t>(indices) * strides_[axis++]), ...);
+
+    return static_cast<size_t>(offset);
+  }
+
+  // lowest and highest offsets start + sum of (dimension - 1) * stride of the negative / positive strides are in [0, size)
+  [[nodiscard]] bool IsInside(size_t size) const {
+    if (start_ >= size) {
+      return false;
+    }
+    auto lowest = start_;
+    auto highest = start_;
+    for (size_t i = 0; i != Dimension; ++i) {
+      const auto step = static_cast<size_t>(strides_[i] < 0 ? -strides_[i] : strides_[i]);
+      if (step != 0 && dimensions_[i] - 1 > size / step) {  // checked by division, the product may overflow
+        return false;
+      }
+      const auto reach = (dimensions_[i] - 1) * step;
+      if (strides_[i] < 0) {
+        if (reach > lowest) {
+          return false;
+        }
+        lowest -= reach;
+      } else {
+        if (reach >= size - highest) {
+          return false;
+        }
+        highest += reach;
+      }
+    }
+
+    return true;
+  }
+
+  Container* container_;
+  size_t start_;  // index of element (0, ..., 0)
+  size_t dimensions_[Dimension];
+  std::ptrdiff_t strides_[Dimension];
+};
+
+}  // namespace uint17
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include "array_view.h"
+#include "expression.h"
+#include "kernels.h"
+
+/*
+  Decimal text codec for containers of numbers: numbers are separated by whitespace or commas.
+  Numbers go through the bulk Unpack / Pack path block by block and are converted with
+  std::to_chars / std::from_chars (no locale, no per-number stream calls),
+  output is collected into a large buffer and handed to the streambuf in one call.
+ */
+namespace uint17::text {
+
+constexpr size_t kBufferSize = 1 << 16;
+constexpr size_t kMaxDigits = 10;  // UINT32_MAX has 10 digits
+
+class ParseError : public std::runtime_error {
+ public:
+  ParseError(size_t index, const std::string& message)
+    : std::runtime_error("text::Read, number " + std::to_string(index) + ": " + message), index_(index) {}
+
+  // index of the number that failed, relative to the start of the read
+  [[nodiscard]] size_t GetIndex() const { return index_; }
+
+ private:
+  size_t index_;
+};
+
+namespace detail {
+
+template <typename Container>
+constexpr size_t ElementBitLength() {
+  using Element = std::remove_cvref_t<decltype(std::declval<Container&>()[size_t{}])>;
+  if constexpr (requires { Element::kBitLength; }) {
+    return Element::kBitLength;
+  } else {
+    return 32;
+  }
+}
+
+// largest number a container element can hold, bigger ones are reported instead of being truncated
+template <typename Container>
+constexpr uint64_t kMaxValue = (uint64_t{1} << ElementBitLength<Container>()) - 1;
+
+constexpr bool IsSeparator(int c) {
+  return c == ' ' || c == ',' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+constexpr bool IsDigit(int c) {
+  return c >= '0' && c <= '9';
+}
+
+[[noreturn]] inline void ThrowMalformed(const char* first, const char* last, size_t index, bool is_cut = false) {
+  throw ParseError(index, "malformed number '" + std::string(first, last) + (is_cut ? "...'" : "'"));
+}
+
+// the whole token is checked for digits, leading zeros do not count towards the range
+template <typename Container>
+uint32_t Convert(const char* first, const char* last, size_t index) {
+  for (const auto* position = first; position != last; ++position) {
+    if (!IsDigit(*position)) {
+      ThrowMalformed(first, last, index);
+    }
+  }
+  while (last - first > 1 && *first == '0') {
+    ++first;
+  }
+  if (last - first > static_cast<std::ptrdiff_t>(kMaxDigits)) {
+    throw ParseError(index, "number out of range");
+  }
+  uint64_t value = 0;
+  const auto [end, error] = std::from_chars(first, last, value);
+  if (error != std::errc{} || end != last) {
+    ThrowMalformed(first, last, index);
+  }
+  if (value > kMaxValue<Container>) {
+    throw ParseError(index, "number out of range " + std::to_string(value));
+  }
+
+  return static_cast<uint32_t>(value);
+}
+
+}  // namespace detail
+
+// writes numbers [start, start + length) of container separated by separator, without a trailing one
+template <RandomAccessContainer Container>
+void Write(std::ostream& stream, const Container& container, size_t start, size_t length, char separator = ' ') {
+  const std::ostream::sentry sentry(stream);
+  if (!sentry) {
+    return;
+  }
+  char buffer[kBufferSize];
+  size_t used = 0;
+  auto flush = [&] {
+    if (stream.rdbuf()->sputn(buffer, static_cast<std::streamsize>(used)) != static_cast<std::streamsize>(used)) {
+      stream.setstate(std::ios::badbit);
+    }
+    used = 0;
+  };
+  uint32_t lanes[kernels::kBlockLength];
+  for (size_t i = 0; i < length; i += kernels::kBlockLength) {
+    const auto block = (length - i < kernels::kBlockLength) ? length - i : kernels::kBlockLength;
+    expression::LoadRange(container, start + i, block, lanes);
+    for (size_t k = 0; k != block; ++k) {
+      if (kBufferSize - used < kMaxDigits + 1) {
+        flush();
+      }
+      if (i + k != 0) {
+        buffer[used++] = separator;
+      }
+      used = static_cast<size_t>(std::to_chars(buffer + used, buffer + kBufferSize, lanes[k]).ptr - buffer);
+    }
+  }
+  flush();
+}
+
+/*
+  Reads length numbers into [start, start + length) of container, leading separators are skipped
+  and the stream is left right after the last number. Throws ParseError on a malformed number,
+  a number that does not fit into an element, or an early end of input,
+  numbers of the blocks completed before the error are already stored
+ */
+template <RandomAccessContainer Container>
+void Read(std::istream& stream, Container& container, size_t start, size_t length) {
+  auto* buffer = stream.rdbuf();
+  char token[kMaxDigits + 1];
+  uint32_t lanes[kernels::kBlockLength];
+  auto c = buffer->sgetc();
+  for (size_t i = 0; i < length; i += kernels::kBlockLength) {
+    const auto block = (length - i < kernels::kBlockLength) ? length - i : kernels::kBlockLength;
+    for (size_t k = 0; k != block; ++k) {
+      while (c != std::char_traits<char>::eof() && detail::IsSeparator(c)) {
+        c = buffer->snextc();
+      }
+      if (c == std::char_traits<char>::eof()) {
+        stream.setstate(std::ios::eofbit);
+        throw ParseError(i + k, "unexpected end of input");
+      }
+      // only the first characters are kept, a leading zero followed by a digit is dropped so padding fits
+      size_t token_length = 0;
+      bool is_cut = false;
+      bool is_malformed = false;
+      while (c != std::char_traits<char>::eof() && !detail::IsSeparator(c)) {
+        is_malformed = is_malformed || !detail::IsDigit(c);
+        if (token_length == 1 && token[0] == '0' && detail::IsDigit(c)) {
+          token[0] = static_cast<char>(c);
+        } else if (token_length != sizeof(token)) {
+          token[token_length++] = static_cast<char>(c);
+        } else {
+          is_cut = true;
+        }
+        c = buffer->snextc();
+      }
+      if (is_malformed) {
+        detail::ThrowMalformed(token, token + token_length, i + k, is_cut);
+      }
+      lanes[k] = detail::Convert<Container>(token, token + token_length, i + k);
+    }
+    expression::StoreRange(container, start + i, block, lanes);
+  }
+  if (c == std::char_traits<char>::eof()) {
+    stream.setstate(std::ios::eofbit);
+  }
+}
+
+// same as Read from an in-memory text, returns the number of characters consumed
+template <RandomAccessContainer Container>
+size_t Read(std::string_view text, Container& container, size_t start, size_t length) {
+  const auto* position = text.data();
+  const auto* const end = text.data() + text.size();
+  uint32_t lanes[kernels::kBlockLength];
+  for (size_t i = 0; i < length; i += kernels::kBlockLength) {
+    const auto block = (length - i < kernels::kBlockLength) ? length - i : kernels::kBlockLength;
+    for (size_t k = 0; k != block; ++k) {
+      while (position != end && detail::IsSeparator(*position)) {
+        ++position;
+      }
+      if (position == end) {
+        throw ParseError(i + k, "unexpected end of input");
+      }
+      const auto* token_end = position;
+      while (token_end != end && !detail::IsSeparator(*token_end)) {
+        ++token_end;
+      }
+      lanes[k] = detail::Convert<Container>(position, token_end, i + k);
+      position = token_end;
+    }
+    expression::StoreRange(container, start + i, block, lanes);
+  }
+
+  return static_cast<size_t>(position - text.data());
+}
+
+template <size_t Dimension, RandomAccessContainer Container>
+void Write(std::ostream& stream, const ArrayView<Dimension, Container>& view, char separator = ' ') {
+  Write(stream, view.GetContainer(), view.GetStart(), view.GetLength(), separator);
+}
+template <size_t Dimension, RandomAccessContainer Container>
+void Read(std::istream& stream, const ArrayView<Dimension, Container>& view) {
+  Read(stream, view.GetContainer(), view.GetStart(), view.GetLength());
+}
+template <size_t Dimension, RandomAccessContainer Container>
+size_t Read(std::string_view text, const ArrayView<Dimension, Container>& view) {
+  return Read(text, view.GetContainer(), view.GetStart(), view.GetLength());
+}
+
+}  // namespace uint17::text
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace uint17 {
+
+/*
+  Fixed set of worker threads that run one ParallelFor at a time.
+  The calling thread works too, so ThreadPool(1) has no workers and runs everything inline.
+  A ParallelFor issued from inside a task runs inline instead of deadlocking the pool
+ */
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t thread_count = DefaultThreadCount()) {
+    for (size_t i = 1; i < thread_count; ++i) {
+      workers_.emplace_back([this] { WorkerLoop(); });
+    }
+  }
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ~ThreadPool() {
+    {
+      std::lock_guard lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  [[nodiscard]] size_t GetThreadCount() const { return workers_.size() + 1; }
+
+  // calls function(i) for every i in [0, task_count), returns when all are done, rethrows the first exception
+  void ParallelFor(size_t task_count, const std::function<void(size_t)>& function) {
+    if (task_count == 0) {
+      return;
+    }
+    if (workers_.empty() || task_count == 1 || inside_task_) {
+      for (size_t i = 0; i != task_count; ++i) {
+        function(i);
+      }
+      return;
+    }
+    std::lock_guard job_lock(job_mutex_);  // one job at a time when several threads share the pool
+    {
+      std::lock_guard lock(mutex_);
+      function_ = &function;
+      task_count_ = task_count;
+      next_task_ = 0;
+      unfinished_ = task_count;
+      error_ = nullptr;
+      ++generation_;
+    }
+    wake_.notify_all();
+    RunTasks(function, task_count);
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [this] { return unfinished_ == 0 && active_workers_ == 0; });
+    function_ = nullptr;
+    if (error_ != nullptr) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+  // pool shared by the library, one thread per hardware thread
+  static ThreadPool& Default() {
+    static ThreadPool pool;
+
+    return pool;
+  }
+  static size_t DefaultThreadCount() { return std::max<size_t>(std::thread::hardware_concurrency(), 1); }
+
+ private:
+  void WorkerLoop() {
+    size_t seen_generation = 0;
+    while (true) {
+      const std::function<void(size_t)>* function;
+      size_t task_count;
+      {
+        std::unique_lock lock(mutex_);
+        wake_.wait(lock, [&] { return stopping_ || generation_ != seen_generation; });
+        if (stopping_) {
+          return;
+        }
+        seen_generation = generation_;
+        if (function_ == nullptr) {  // woke up after the job was over
+          continue;
+        }
+        function = function_;
+        task_count = task_count_;
+        ++active_workers_;  // the job may not end while this worker holds function
+      }
+      RunTasks(*function, task_count);
+      std::lock_guard lock(mutex_);
+      if (--active_workers_ == 0) {
+        done_.notify_all();
+      }
+    }
+  }
+
+  void RunTasks(const std::function<void(size_t)>& function, size_t task_count) {
+    inside_task_ = true;
+    size_t finished = 0;
+    while (true) {
+      const auto task = next_task_.fetch_add(1);
+      if (task >= task_count) {
+        break;
+      }
+      try {
+        function(task);
+      } catch (...) {
+        std::lock_guard lock(mutex_);
+        if (error_ == nullptr) {
+          error_ = std::current_exception();
+        }
+      }
+      ++finished;
+    }
+    inside_task_ = false;
+    if (finished != 0) {
+      std::lock_guard lock(mutex_);
+      unfinished_ -= finished;
+      if (unfinished_ == 0) {
+        done_.notify_all();
+      }
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::mutex job_mutex_;
+  std::mutex mutex_;  // guards everything below except next_task_
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  const std::function<void(size_t)>* function_ = nullptr;
+  size_t task_count_ = 0;
+  std::atomic<size_t> next_task_ = 0;
+  size_t unfinished_ = 0;
+  size_t active_workers_ = 0;
+  size_t generation_ = 0;
+  std::exception_ptr error_;
+  bool stopping_ = false;
+  static inline thread_local bool inside_task_ = false;
+};
+
+/*
+  Splits [0, length) into pieces and calls function(begin, end) for them on the pool.
+  Inner borders are placed where (start + border) % alignment == 0: for a packed container with start
+  as the index of position 0 and alignment = packing::kGroupLength every piece begins on a byte boundary,
+  so threads writing different pieces never touch the same byte. Alignment 0 runs function(0, length) on the calling thread
+ */
+template <typename Function>
+void ParallelForRange(ThreadPool& pool, size_t start, size_t length, size_t alignment, size_t min_piece,
+                      Function&& function) {
+  if (alignment == 0) {
+    function(size_t{0}, length);
+    return;
+  }
+  const auto max_pieces = std::max<size_t>(length / std::max(min_piece, alignment), 1);
+  const auto piece_count = std::min(max_pieces, pool.GetThreadCount() * 4);  // a few pieces per thread for balance
+  if (piece_count == 1) {
+    function(size_t{0}, length);
+    return;
+  }
+  auto border = [&](size_t piece) -> size_t {  // first position of piece, rounded down to the alignment
+    if (piece == 0) {
+      return 0;
+    }
+    if (piece == piece_count) {
+      return length;
+    }
+    const auto position = start + length / piece_count * piece;
+
+    return position / alignment * alignment - start;
+  };
+  pool.ParallelFor(piece_count, [&](size_t piece) {
+    const auto begin = border(piece);
+    const auto end = border(piece + 1);
+    if (begin < end) {
+      function(begin, end);
+    }
+  });
+}
+
+}  // namespace uint17
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <concepts>
+#include <iostream>
+#include <climits>
+#include "packing.h"
+
+namespace uint17 {
+
+/*
+  Interprets Bits bits starting at bit offset (0..7) of data as an unsigned number, most significant bit first.
+  Header-only, masks and shifts depend only on Bits, so element access inlines into the caller's loop.
+  Reads and writes load a whole word (see packing::ReadBits), so the bytes of the number must be followed by
+  packing::kTailSlack readable bytes: buffers of Array, MappedArray and BufferPool have them, a view over
+  other memory needs a buffer of the number's bytes + packing::kTailSlack. Writes store only the bytes of the number
+ */
+template <size_t Bits> requires (Bits >= 1 && Bits <= 32)
+class UIntNView {
+ public:
+  static constexpr size_t kBitLength = Bits;
+
+  UIntNView(uint8_t* data, uint8_t offset): data_(data), offset_(offset) {}
+  UIntNView(const UIntNView& other) = default;
+
+  UIntNView& SetToZero() { return *this = uint32_t{0}; }
+  UIntNView& operator=(uint16_t number) { return *this = static_cast<uint32_t>(number); }
+  UIntNView& operator=(uint32_t number) {  // overflow ignored
+    packing::WriteBits<Bits>(data_, offset_, number);
+
+    return *this;
+  }
+  UIntNView& operator=(const UIntNView& other) { return *this = other.ToUInt32(); }
+  [[nodiscard]] uint32_t ToUInt32() const { return packing::ReadBits<Bits>(data_, offset_); }
+  operator uint32_t() const { return ToUInt32(); }  // lets iterators satisfy std::random_access_iterator
+
+  UIntNView& operator+=(const UIntNView& other) { return *this += other.ToUInt32(); }
+  UIntNView& operator+=(uint32_t other) { return *this = ToUInt32() + other; }
+  UIntNView& operator-=(const UIntNView& other) { return *this -= other.ToUInt32(); }
+  UIntNView& operator-=(uint32_t other) { return *this = ToUInt32() - other; }
+  UIntNView& operator*=(const UIntNView& other) { return *this *= other.ToUInt32(); }
+  UIntNView& operator*=(uint32_t other) { return *this = ToUInt32() * other; }
+
+ private:
+  uint8_t* data_;  // pointer to first byte of number
+  uint8_t offset_;  // number of bit in first byte of number (from 0 to 7)
+};
+
+// views whose layout is the plain packed bit stream of packing.h, so containers may use the bulk kernels
+template <typename T>
+concept PackedNumberView = std::same_as<T, UIntNView<T::kBitLength>>;
+
+}  // namespace uint17
+
+template <size_t Bits>
+std::ostream& operator<<(std::ostream& stream, const uint17::UIntNView<Bits>& value) {
+  stream << value.ToUInt32();
+
+  return stream;
+}
+template <size_t Bits>
+std::istream& operator>>(std::istream& stream, uint17::UIntNView<Bits>& value) {
+  uint32_t number;
+  stream >> number;
+  value = number;
+
+  return stream;
+}
+template <size_t Bits>
+std::istream& operator>>(std::istream& stream, uint17::UIntNView<Bits>&& value) {
+  uint32_t number;
+  stream >> number;
+  value = number;
+
+  return stream;
+}
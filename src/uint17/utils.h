@@ -1,5 +1,9 @@
 #pragma once
 
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <new>
 #include <utility>
 
 namespace uint17::utils {
@@ -11,4 +15,47 @@ void Swap(T& a, T& b) { // I am not allowed to use std::swap
   b = std::move(tmp);
 }
 
+inline uint32_t LoadBigEndian32(const uint8_t* data) {
+  uint32_t result = 0;
+  for (size_t i = 0; i != sizeof(uint32_t); ++i) {
+    result = (result << CHAR_BIT) | data[i];
+  }
+
+  return result;
+}
+
+inline uint64_t LoadBigEndian64(const uint8_t* data) {  // compilers fold it into a single load + bswap
+  uint64_t result = 0;
+  for (size_t i = 0; i != sizeof(uint64_t); ++i) {
+    result = (result << CHAR_BIT) | data[i];
+  }
+
+  return result;
+}
+
+inline void StoreBigEndian64(uint8_t* data, uint64_t value) {
+  for (size_t i = sizeof(uint64_t); i != 0; --i) {
+    data[i - 1] = static_cast<uint8_t>(value);
+    value >>= CHAR_BIT;
+  }
+}
+
+inline void StoreBigEndian32(uint8_t* data, uint32_t value) {
+  for (size_t i = sizeof(uint32_t); i != 0; --i) {
+    data[i - 1] = static_cast<uint8_t>(value);
+    value >>= CHAR_BIT;
+  }
+}
+
+constexpr size_t kCacheLineSize = 64;
+
+// cache-line aligned buffer, free with FreeAligned
+inline uint8_t* AllocateAligned(size_t size) {
+  return static_cast<uint8_t*>(::operator new[](size, std::align_val_t{kCacheLineSize}));
+}
+
+inline void FreeAligned(uint8_t* data) {
+  ::operator delete[](data, std::align_val_t{kCacheLineSize});
+}
+
 } // namespace uint17::utils